@@ -0,0 +1,11 @@
+#include "ack_command.h"
+
+void AckCommand::process(std::string_view args) {
+  if (args == "1") {
+    led_command_.set_acks(&tx_);
+  } else if (args == "0") {
+    led_command_.set_acks(nullptr);
+  } else {
+    Serial.println("Invalid ack command format");
+  }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string_view>
+
+#include "command.h"
+#include "led_command.h"
+#include "tx_queue.h"
+
+// "ack:1" makes LedCommand acknowledge every frame it publishes, "ack:0" turns
+// acknowledgements off again.
+class AckCommand : public Command {
+ public:
+  AckCommand(LedCommand& led_command, TxQueue& tx)
+      : Command("ack"), led_command_(led_command), tx_(tx) {}
+
+  void process(std::string_view args) override;
+
+ private:
+  LedCommand& led_command_;
+  TxQueue& tx_;
+};
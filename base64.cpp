@@ -4,7 +4,7 @@
 
 #include <span>
 
-constexpr int kDecodeTable[256] = {
+constexpr int8_t kDecodeTable[256] = {
     -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  // 0-15
     -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  // 16-31
     -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,  // 32-47
@@ -23,37 +23,79 @@ constexpr int kDecodeTable[256] = {
     -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1   // 240-255
 };
 
+// Decodes whole groups of 4 characters into 3 bytes each, starting on a group
+// boundary. Stops at the first group containing whitespace or an invalid
+// character, or when `out` has no room for another group, and leaves those to
+// the per-character path. Returns the number of characters consumed.
+static size_t DecodeGroups(const uint8_t* in, size_t in_size, uint8_t* out,
+                           size_t out_size, size_t& out_index) {
+  size_t in_index = 0;
+  while (in_index + 4 <= in_size && out_index + 3 <= out_size) {
+    int8_t a = kDecodeTable[in[in_index]];
+    int8_t b = kDecodeTable[in[in_index + 1]];
+    int8_t c = kDecodeTable[in[in_index + 2]];
+    int8_t d = kDecodeTable[in[in_index + 3]];
+    if ((a | b | c | d) < 0) {
+      break;
+    }
+
+    uint32_t word = (static_cast<uint32_t>(a) << 18) |
+                    (static_cast<uint32_t>(b) << 12) |
+                    (static_cast<uint32_t>(c) << 6) | static_cast<uint32_t>(d);
+    out[out_index] = word >> 16;
+    out[out_index + 1] = word >> 8;
+    out[out_index + 2] = word;
+    out_index += 3;
+    in_index += 4;
+  }
+  return in_index;
+}
+
 bool Base64Decode(std::span<const uint8_t> base64, std::span<uint8_t> out) {
+  Base64Decoder decoder;
+  return decoder.Decode(base64, out) >= 0 && decoder.Finish();
+}
+
+int Base64Decoder::Decode(std::span<const uint8_t> base64,
+                          std::span<uint8_t> out) {
   size_t outIndex = 0;
-  int buffer = 0;
-  int bitsLeft = 0;
+  size_t i = 0;
+
+  while (i < base64.size()) {
+    if (bits_left_ == 0) {
+      // Fast path: whole groups while no whitespace or padding shifts them
+      i += DecodeGroups(base64.data() + i, base64.size() - i, out.data(),
+                        out.size(), outIndex);
+      if (i == base64.size()) {
+        break;
+      }
+    }
 
-  for (const uint8_t& byte : base64) {
-    if (byte > 255 || kDecodeTable[byte] == -1) {
+    uint8_t byte = base64[i++];
+    if (kDecodeTable[byte] == -1) {
       if (byte == '=' || byte == '\n' || byte == '\r' || byte == ' ') {
         continue;  // Skip padding or whitespace
       } else {
-        return false;  // Invalid character
+        return -1;  // Invalid character
       }
     }
 
-    buffer = (buffer << 6) | kDecodeTable[byte];
-    bitsLeft += 6;
+    buffer_ = ((buffer_ << 6) | kDecodeTable[byte]) & 0xFFF;
+    bits_left_ += 6;
 
-    if (bitsLeft >= 8) {
-      bitsLeft -= 8;
-      uint8_t decodedByte = (buffer >> bitsLeft) & 0xFF;
+    if (bits_left_ >= 8) {
+      bits_left_ -= 8;
       if (outIndex >= out.size()) {
-        return false;  // Output buffer too small
+        return -1;  // Output buffer too small
       }
-      out[outIndex++] = decodedByte;
+      out[outIndex++] = (buffer_ >> bits_left_) & 0xFF;
     }
   }
 
-  // Check for incomplete byte at the end
-  if (bitsLeft > 0 && (buffer & ((1 << bitsLeft) - 1)) != 0) {
-    return false;  // Trailing bits are not zero, invalid padding
-  }
+  return outIndex;
+}
 
-  return true;
+bool Base64Decoder::Finish() const {
+  // Trailing bits must be zero, otherwise the padding is invalid
+  return bits_left_ == 0 || (buffer_ & ((1 << bits_left_) - 1)) == 0;
 }
@@ -5,3 +5,26 @@
 #include <span>
 
 bool Base64Decode(std::span<const uint8_t> base64, std::span<uint8_t> out);
+
+// Incremental base64 decoder for input that arrives in pieces. Whitespace and
+// padding are skipped, as in Base64Decode(). Runs of complete 4-character
+// groups are decoded a 24-bit word at a time.
+class Base64Decoder {
+ public:
+  void Reset() {
+    buffer_ = 0;
+    bits_left_ = 0;
+  }
+
+  // Decodes `base64`, writing the decoded bytes to `out`. Returns the number
+  // of bytes written, or -1 if an invalid character was found or `out` is too
+  // small.
+  int Decode(std::span<const uint8_t> base64, std::span<uint8_t> out);
+
+  // Returns true if the input decoded so far ends without stray trailing bits.
+  bool Finish() const;
+
+ private:
+  int buffer_ = 0;
+  int bits_left_ = 0;
+};
@@ -0,0 +1,126 @@
+"""Messages/s of ControllerState's batched writer against a fake controller.
+
+    python3 -m bench.bench_writer [--messages N] [--frames N] [--leds N]
+
+Each case issues messages from concurrent tasks, as main.py's button handler
+does, and runs until the fake controller on a loopback socket has received
+everything. "unbatched" prints and writes every message with its own
+sock_sendall, as ControllerState did before messages were queued per event
+loop tick; printing goes to os.devnull rather than a terminal.
+
+On loopback the rate is bound by the event loop, not the socket, so the
+writes per message column is the better guide to what a real network and
+the CH9121 see.
+"""
+
+import argparse
+import asyncio
+import contextlib
+import os
+import socket
+import time
+
+from control_port import ControllerState
+from tests.fake_controller import FakeController
+
+TASKS_PER_TICK = 50  # Messages issued together, e.g. a screen update
+
+
+async def _wait_for(controller, lines, frames):
+    while len(controller.lines) < lines or len(controller.frames) < frames:
+        await asyncio.sleep(0.0005)
+
+
+async def bench_unbatched(controller, messages):
+    loop = asyncio.get_running_loop()
+    sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    sock.setblocking(False)
+    await loop.sock_connect(sock, (controller.host, controller.port))
+
+    async def send(i):
+        msg = f"lcd:0:{i % 4}:line {i}\n".encode()
+        print(f"Sending message to {controller.host}: {msg}")
+        await loop.sock_sendall(sock, msg)
+
+    start = time.perf_counter()
+    with open(os.devnull, "w") as devnull, contextlib.redirect_stdout(devnull):
+        for first in range(0, messages, TASKS_PER_TICK):
+            count = min(TASKS_PER_TICK, messages - first)
+            await asyncio.gather(*[send(first + i) for i in range(count)])
+        await _wait_for(controller, messages, 0)
+    elapsed = time.perf_counter() - start
+    sock.close()
+    return messages, elapsed
+
+
+async def bench_lcd(state, controller, messages):
+    start = time.perf_counter()
+    for first in range(0, messages, TASKS_PER_TICK):
+        count = min(TASKS_PER_TICK, messages - first)
+        await asyncio.gather(
+            *[state.set_lcd(0, (first + i) % 4, f"line {first + i}") for i in range(count)]
+        )
+    await _wait_for(controller, messages, 0)
+    return messages, time.perf_counter() - start
+
+
+async def bench_leds(state, controller, messages, leds):
+    """LED frames issued TASKS_PER_TICK per tick, all sent or coalesced."""
+    frames = [[(i, (i * 7 + f) & 0xFF, 40) for i in range(leds)] for f in range(16)]
+    start = time.perf_counter()
+    sent = 0
+    for first in range(0, messages, TASKS_PER_TICK):
+        count = min(TASKS_PER_TICK, messages - first)
+        await asyncio.gather(*[state.set_leds(frames[(first + i) % 16]) for i in range(count)])
+        sent += 1 if state.coalesce else count
+    await _wait_for(controller, 0, sent)
+    return messages, time.perf_counter() - start
+
+
+async def run(messages, frames, leds):
+    loop = asyncio.get_running_loop()
+    cases = [
+        ("lcd unbatched", lambda state, ctrl: bench_unbatched(ctrl, messages), {}),
+        ("lcd batched", lambda state, ctrl: bench_lcd(state, ctrl, messages), {}),
+        (
+            f"led {leds} batched",
+            lambda state, ctrl: bench_leds(state, ctrl, frames, leds),
+            {"coalesce": False},
+        ),
+        (f"led {leds} coalesced", lambda state, ctrl: bench_leds(state, ctrl, frames, leds), {}),
+    ]
+    # Count socket writes
+    writes = 0
+    sock_sendall = loop.sock_sendall
+
+    async def counting_sendall(sock, data):
+        nonlocal writes
+        writes += 1
+        await sock_sendall(sock, data)
+
+    loop.sock_sendall = counting_sendall
+
+    print(f"{'case':<24}{'messages/s':>14}{'writes/message':>16}")
+    for name, bench, state_args in cases:
+        writes = 0
+        controller = await FakeController().start()
+        state = ControllerState(controller.host, 0, loop, port=controller.port, **state_args)
+        try:
+            issued, elapsed = await bench(state, controller)
+        finally:
+            state.disconnect()
+            await controller.stop()
+        print(f"{name:<24}{issued / elapsed:>14.0f}{writes / issued:>16.3f}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--messages", type=int, default=20000)
+    parser.add_argument("--frames", type=int, default=2000)
+    parser.add_argument("--leds", type=int, default=512)
+    args = parser.parse_args()
+    asyncio.run(run(args.messages, args.frames, args.leds))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,45 @@
+#include "button_scanner.h"
+
+#include <Arduino.h>
+
+void ButtonScanner::begin() {
+  pinMode(int_pin_, INPUT_PULLUP);
+  stable_ = candidate_ = pca_.readButtons();
+  settling_ = false;
+}
+
+void ButtonScanner::poll(uint32_t now_ms) {
+  // INT is active low until the inputs are read, so also check the level in
+  // case an edge was missed
+  if (irq_ || digitalRead(int_pin_) == LOW) {
+    // Clear before reading so a change during the read raises it again
+    irq_ = false;
+    sample(now_ms);
+  } else if (settling_ && now_ms - candidate_since_ >= DEBOUNCE_MS) {
+    sample(now_ms);
+  }
+}
+
+void ButtonScanner::sample(uint32_t now_ms) {
+  uint8_t raw = pca_.readButtons();
+  if (raw != candidate_) {
+    if (!settling_) first_change_ = now_ms;
+    candidate_ = raw;
+    candidate_since_ = now_ms;
+    settling_ = true;
+    return;
+  }
+
+  if (!settling_ || now_ms - candidate_since_ < DEBOUNCE_MS) return;
+  settling_ = false;
+  if (candidate_ == stable_) return;  // Bounced back to where it was
+
+  stable_ = candidate_;
+  ButtonEvent event = {stable_, first_change_};
+  if (!events_.push(event)) {
+    // Drop the oldest state rather than the newest
+    ButtonEvent stale;
+    events_.pop(stale);
+    events_.push(event);
+  }
+}
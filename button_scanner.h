@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "pca9555.h"
+#include "ring_buffer.h"
+
+struct ButtonEvent {
+  uint8_t state;     // Debounced button bitmask after the change
+  uint32_t time_ms;  // millis() when the change was first seen
+};
+
+// Scans the PCA9555 buttons only when its INT line signals a change, debounces
+// the result and queues timestamped events. When no input changes, scanning
+// causes no I2C traffic.
+class ButtonScanner {
+ public:
+  static constexpr uint32_t DEBOUNCE_MS = 10;
+  static constexpr size_t MAX_EVENTS = 16;
+
+  ButtonScanner(PCA9555& pca, uint8_t int_pin) : pca_(pca), int_pin_(int_pin) {}
+
+  // Configure the INT pin and read the initial button state
+  void begin();
+
+  // Called from the INT pin interrupt handler
+  void notify() { irq_ = true; }
+
+  // Read the buttons if INT fired or a change is settling. Call from loop().
+  void poll(uint32_t now_ms);
+
+  // Take the oldest queued event, returns false if there is none
+  bool pop(ButtonEvent& event) { return events_.pop(event); }
+
+  // Current debounced button state
+  uint8_t state() const { return stable_; }
+
+ private:
+  PCA9555& pca_;
+  const uint8_t int_pin_;
+  volatile bool irq_ = false;
+
+  uint8_t stable_ = 0;
+  uint8_t candidate_ = 0;
+  bool settling_ = false;
+  uint32_t candidate_since_ = 0;
+  uint32_t first_change_ = 0;
+  RingBuffer<ButtonEvent, MAX_EVENTS> events_;
+
+  void sample(uint32_t now_ms);
+};
@@ -24,67 +24,141 @@ class CH9121 {
          uint8_t cfg_pin)
       : uart_(uart), config_(config), rst_pin_(rst_pin), cfg_pin_(cfg_pin) {}
 
+  // Time to wait for the reply to one configuration command
+  static constexpr uint32_t REPLY_TIMEOUT_MS = 100;
+  // Time to wait for the module to answer after entering configuration mode
+  static constexpr uint32_t READY_TIMEOUT_MS = 1000;
+  // Longest time to wait for received data to be consumed before entering
+  // configuration mode
+  static constexpr uint32_t PENDING_TIMEOUT_MS = 500;
+
   // Begin function to set pin modes and initialize UART communication
   void Begin() {
     pinMode(rst_pin_, OUTPUT);
     pinMode(cfg_pin_, OUTPUT);
     digitalWrite(rst_pin_, HIGH);  // Set RST pin high
     digitalWrite(cfg_pin_, HIGH);  // Set CFG pin high
-    delay(500);
   }
 
-  // Function to start the CH9121 configuration
-  void StartConfiguration() {
-    digitalWrite(cfg_pin_, LOW);
-    digitalWrite(rst_pin_, HIGH);
-    delay(500);
-
-    // Set UART baud rate to the initial setup rate.
-    uart_->begin(9600);
+  // Configures the device with settings in config_, blocking until done.
+  // Returns the number of fields written.
+  int Configure() {
+    StartConfigure();
+    EnterConfigMode();
+    while (Step()) {
+    }
+    return written_;
   }
 
-  // Function to end the CH9121 configuration
-  void EndConfiguration() {
-    SendSimpleCommand(0x0D);  // Save settings
-    delay(200);
-    SendSimpleCommand(0x0E);  // Apply settings
-    delay(200);
-    SendSimpleCommand(0x5E);  // Exit config mode
-    delay(500);
-    digitalWrite(cfg_pin_, HIGH);  // Set CFG pin high
+  // Starts reconfiguring the target IP and port in the background. Step()
+  // performs the configuration.
+  void Reconfigure(const uint8_t* new_target_ip, uint16_t new_target_port) {
+    // Update the internal config
+    memcpy(config_.target_ip, new_target_ip, 4);
+    config_.target_port = new_target_port;
+
+    StartConfigure();
+  }
 
-    // Set UART baud rate to match configuration
-    uart_->begin(config_.baud_rate);
+  // Starts configuring the device with settings in config_. The module's
+  // stored settings are read back first and only the fields that differ are
+  // written, and they are only saved and applied (which resets the module) if
+  // something was written.
+  void StartConfigure() {
+    if (phase_ != kIdle) return;
+    written_ = 0;
+    responded_ = false;
+    phase_ = kPending;
+    phase_start_ = millis();
   }
 
-  // Configures the device with settings in config_
-  void Configure() {
-    StartConfiguration();
+  // Advances a configuration started with StartConfigure() without blocking.
+  // Configuration mode is only entered once no received data is waiting, or
+  // after PENDING_TIMEOUT_MS if the host keeps sending. Returns true while the
+  // configuration is in progress.
+  //
+  // In configuration mode the UART carries configuration commands, and any
+  // network data arriving on it until the module resets is discarded, so the
+  // host must not send anything between the start and the end.
+  bool Step() {
+    switch (phase_) {
+      case kIdle:
+        return false;
+      case kPending:
+        if (uart_->available() &&
+            millis() - phase_start_ < PENDING_TIMEOUT_MS) {
+          return true;
+        }
+        EnterConfigMode();
+        return true;
+      default:
+        break;
+    }
+
+    uint8_t* reply = reply_;
+    Reply status = PollReply();
+    if (status == kWaiting) return true;
+    bool received = status == kReceived;
 
-    SetMode(config_.mode);
-    SetLocalIP(config_.local_ip);
-    SetSubnetMask(config_.subnet_mask);
-    SetGateway(config_.gateway);
-    SetTargetIP(config_.target_ip);
-    SetLocalPort(config_.local_port);
-    SetTargetPort(config_.target_port);
-    SetBaudRate(config_.baud_rate);
+    switch (phase_) {
+      case kWaitReady:
+        if (received) {
+          responded_ = true;
+          StartField(0);
+        } else if (millis() - phase_start_ < READY_TIMEOUT_MS) {
+          // Not up yet, ask again
+          Send(0x60, nullptr, 0, 1);
+        } else {
+          // No answer, so write every field as the module may still listen
+          StartField(0);
+        }
+        break;
+      case kQuery: {
+        const Field& field = FIELDS[field_];
+        if (received &&
+            memcmp(reply, FieldValue(field_), field.length) == 0) {
+          StartField(field_ + 1);
+        } else {
+          WriteField();
+        }
+        break;
+      }
+      case kSet:
+        StartField(field_ + 1);
+        break;
+      case kSave:
+        Send(0x0E, nullptr, 0, 1);  // Apply settings
+        phase_ = kApply;
+        break;
+      case kApply:
+        Send(0x5E, nullptr, 0, 1);  // Exit config mode
+        phase_ = kExit;
+        break;
+      case kExit:
+        digitalWrite(cfg_pin_, HIGH);  // Set CFG pin high
 
-    EndConfiguration();
+        // Set UART baud rate to match configuration
+        uart_->begin(config_.baud_rate);
+        phase_ = kIdle;
+        return false;
+      default:
+        break;
+    }
+    return true;
   }
 
-  // Reconfigures the target IP and port
-  void Reconfigure(const uint8_t* new_target_ip, uint16_t new_target_port) {
-    // Update the internal config
-    memcpy(config_.target_ip, new_target_ip, 4);
-    config_.target_port = new_target_port;
+  // True from StartConfigure() until Step() has finished
+  bool Busy() const { return phase_ != kIdle; }
 
-    // Apply the new configuration
-    StartConfiguration();
-    SetTargetIP(config_.target_ip);
-    SetTargetPort(config_.target_port);
-    EndConfiguration();
-  }
+  // True while the module is in configuration mode, when the UART carries
+  // configuration commands instead of network data
+  bool InConfigMode() const { return phase_ > kPending; }
+
+  // Fields written by the last configuration
+  int FieldsWritten() const { return written_; }
+
+  // Whether the module answered during the last configuration
+  bool Responded() const { return responded_; }
 
   // Main function to handle RX/TX for debugging purposes
   void HandleRXTX() {
@@ -103,60 +177,152 @@ class CH9121 {
   uint8_t cfg_pin_;
   uint8_t tx_buffer_[8] = {0x57, 0xAB};
 
-  // Helper function to send a simple 3-byte command
-  void SendSimpleCommand(uint8_t command) {
-    tx_buffer_[2] = command;
-    uart_->write(tx_buffer_, 3);
-    delay(100);
+  static constexpr uint8_t REPLY_OK = 0xAA;
+
+  enum Phase : uint8_t {
+    kIdle,
+    kPending,    // Waiting for received data to be consumed
+    kWaitReady,  // Polling until the module answers in configuration mode
+    kQuery,      // Reading back the current field
+    kSet,        // Writing the current field
+    kSave,
+    kApply,
+    kExit,
+  };
+
+  enum Reply : uint8_t { kWaiting, kReceived, kTimedOut };
+
+  // Settings in configuration order, with their query and set commands
+  struct Field {
+    uint8_t query;
+    uint8_t set;
+    uint8_t length;
+  };
+  static constexpr Field FIELDS[] = {
+      {0x60, 0x10, 1},  // Mode
+      {0x61, 0x11, 4},  // Local IP
+      {0x62, 0x12, 4},  // Subnet mask
+      {0x63, 0x13, 4},  // Gateway
+      {0x64, 0x14, 2},  // Local port
+      {0x65, 0x15, 4},  // Target IP
+      {0x66, 0x16, 2},  // Target port
+      {0x71, 0x21, 4},  // Baud rate
+  };
+  static constexpr size_t NUM_FIELDS = sizeof(FIELDS) / sizeof(FIELDS[0]);
+
+  Phase phase_ = kIdle;
+  uint32_t phase_start_ = 0;
+  size_t field_ = 0;
+  uint8_t value_[4];  // Current field in the module's byte order
+  int written_ = 0;
+  bool responded_ = false;
+
+  // Reply to the last command sent
+  uint8_t reply_[4];
+  size_t reply_length_ = 0;
+  size_t reply_received_ = 0;
+  uint32_t sent_at_ = 0;
+
+  static void PutLittleEndian(uint8_t* out, uint32_t value, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+      out[i] = (value >> (8 * i)) & 0xFF;
+    }
   }
 
-  // Helper function to send 4-byte commands (mode, etc.)
-  void Send4ByteCommand(uint8_t data, uint8_t command) {
-    tx_buffer_[2] = command;
-    tx_buffer_[3] = data;
-    uart_->write(tx_buffer_, 4);
-    delay(100);
+  void EnterConfigMode() {
+    // Let data still being sent to the network go out at the old baud rate
+    uart_->flush();
+
+    digitalWrite(cfg_pin_, LOW);
+    digitalWrite(rst_pin_, HIGH);
+
+    // Set UART baud rate to the initial setup rate.
+    uart_->begin(9600);
+
+    // Poll with a harmless query until the module is ready, rather than
+    // sleeping for its worst case start-up time
+    phase_ = kWaitReady;
+    phase_start_ = millis();
+    Send(0x60, nullptr, 0, 1);
   }
 
-  // Helper function to send 5-byte commands (port, etc.)
-  void Send5ByteCommand(uint16_t data, uint8_t command) {
-    tx_buffer_[2] = command;
-    tx_buffer_[3] = data & 0xFF;
-    tx_buffer_[4] = (data >> 8) & 0xFF;
-    uart_->write(tx_buffer_, 5);
-    delay(100);
+  // Returns the value config_ wants for field index in the module's byte order
+  const uint8_t* FieldValue(size_t index) {
+    switch (FIELDS[index].set) {
+      case 0x10:
+        return &config_.mode;
+      case 0x11:
+        return config_.local_ip;
+      case 0x12:
+        return config_.subnet_mask;
+      case 0x13:
+        return config_.gateway;
+      case 0x14:
+        PutLittleEndian(value_, config_.local_port, 2);
+        return value_;
+      case 0x15:
+        return config_.target_ip;
+      case 0x16:
+        PutLittleEndian(value_, config_.target_port, 2);
+        return value_;
+      default:
+        PutLittleEndian(value_, config_.baud_rate, 4);
+        return value_;
+    }
   }
 
-  // Helper function to send 7-byte commands (IP, gateway, subnet mask)
-  void Send7ByteCommand(uint8_t data[], uint8_t command) {
-    tx_buffer_[2] = command;
-    for (int i = 0; i < 4; i++) {
-      tx_buffer_[3 + i] = data[i];
+  // Reads back field index, or writes it if the module has not answered.
+  // After the last field, saves the settings if any were written.
+  void StartField(size_t index) {
+    field_ = index;
+    if (index == NUM_FIELDS) {
+      if (written_ > 0) {
+        Send(0x0D, nullptr, 0, 1);  // Save settings
+        phase_ = kSave;
+      } else {
+        Send(0x5E, nullptr, 0, 1);  // Exit config mode
+        phase_ = kExit;
+      }
+    } else if (responded_) {
+      Send(FIELDS[index].query, nullptr, 0, FIELDS[index].length);
+      phase_ = kQuery;
+    } else {
+      WriteField();
     }
-    uart_->write(tx_buffer_, 7);
-    delay(100);
   }
 
-  // Helper function to send baud rate configuration command
-  void SendBaudRateCommand(uint32_t data, uint8_t command) {
+  void WriteField() {
+    Send(FIELDS[field_].set, FieldValue(field_), FIELDS[field_].length, 1);
+    written_++;
+    phase_ = kSet;
+  }
+
+  // Sends a command followed by length bytes of data and expects
+  // reply_length reply bytes, which PollReply() collects
+  void Send(uint8_t command, const uint8_t* data, size_t length,
+            size_t reply_length) {
+    // Discard anything left over from an earlier command that timed out
+    while (uart_->available()) uart_->read();
+
     tx_buffer_[2] = command;
-    tx_buffer_[3] = data & 0xFF;
-    tx_buffer_[4] = (data >> 8) & 0xFF;
-    tx_buffer_[5] = (data >> 16) & 0xFF;
-    tx_buffer_[6] = (data >> 24) & 0xFF;
-    uart_->write(tx_buffer_, 7);
-    delay(100);
+    if (length > 0) memcpy(tx_buffer_ + 3, data, length);
+    uart_->write(tx_buffer_, 3 + length);
+
+    reply_length_ = reply_length;
+    reply_received_ = 0;
+    sent_at_ = millis();
   }
 
-  // Setters for various configuration parameters
-  void SetMode(uint8_t mode) { Send4ByteCommand(mode, 0x10); }
-  void SetLocalIP(uint8_t ip[]) { Send7ByteCommand(ip, 0x11); }
-  void SetSubnetMask(uint8_t subnet[]) { Send7ByteCommand(subnet, 0x12); }
-  void SetGateway(uint8_t gateway[]) { Send7ByteCommand(gateway, 0x13); }
-  void SetTargetIP(uint8_t target_ip[]) { Send7ByteCommand(target_ip, 0x15); }
-  void SetLocalPort(uint16_t port) { Send5ByteCommand(port, 0x14); }
-  void SetTargetPort(uint16_t target_port) {
-    Send5ByteCommand(target_port, 0x16);
+  // Collects reply bytes that have arrived. Acknowledgements other than
+  // REPLY_OK count as timed out.
+  Reply PollReply() {
+    while (reply_received_ < reply_length_ && uart_->available()) {
+      reply_[reply_received_++] = uart_->read();
+    }
+    if (reply_received_ == reply_length_) {
+      bool is_ack = phase_ != kQuery && phase_ != kWaitReady;
+      return is_ack && reply_[0] != REPLY_OK ? kTimedOut : kReceived;
+    }
+    return millis() - sent_at_ < REPLY_TIMEOUT_MS ? kWaiting : kTimedOut;
   }
-  void SetBaudRate(uint32_t baud_rate) { SendBaudRateCommand(baud_rate, 0x21); }
 };
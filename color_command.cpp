@@ -0,0 +1,61 @@
+#include "color_command.h"
+
+#include <Arduino.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <charconv>
+#include <system_error>
+
+bool ColorCommand::parse_byte(std::string_view args, size_t index,
+                              uint8_t& value) {
+  for (; index > 0; --index) {
+    size_t colon = args.find(':');
+    if (colon == std::string_view::npos) return false;
+    args.remove_prefix(colon + 1);
+  }
+  std::string_view token = args.substr(0, args.find(':'));
+  auto result =
+      std::from_chars(token.data(), token.data() + token.size(), value);
+  return result.ec == std::errc() && result.ptr == token.data() + token.size();
+}
+
+void ColorCommand::process(std::string_view args) {
+  size_t colon = args.find(':');
+  std::string_view name = args.substr(0, colon);
+  std::string_view values =
+      colon == std::string_view::npos ? "" : args.substr(colon + 1);
+
+  ColorPipeline::Settings settings = pipeline_.settings();
+  bool ok = false;
+  if (name == "reset") {
+    settings = ColorPipeline::Settings();
+    ok = values.empty();
+  } else if (name == "gamma") {
+    // strtof needs a terminated string
+    char buf[16];
+    if (!values.empty() && values.size() < sizeof(buf)) {
+      memcpy(buf, values.data(), values.size());
+      buf[values.size()] = '\0';
+      char* end;
+      float gamma = strtof(buf, &end);
+      ok = end == buf + values.size() && gamma > 0.0f && gamma <= 5.0f;
+      settings.gamma = gamma;
+    }
+  } else if (name == "brightness") {
+    ok = values.find(':') == std::string_view::npos &&
+         parse_byte(values, 0, settings.brightness);
+  } else if (name == "balance") {
+    ok = std::count(values.begin(), values.end(), ':') == 2 &&
+         parse_byte(values, 0, settings.balance[0]) &&
+         parse_byte(values, 1, settings.balance[1]) &&
+         parse_byte(values, 2, settings.balance[2]);
+  }
+
+  if (!ok) {
+    Serial.println("Invalid color command format");
+    return;
+  }
+  pipeline_.configure(settings);
+}
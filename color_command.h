@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string_view>
+
+#include "color_pipeline.h"
+#include "command.h"
+
+// Adjusts the ColorPipeline applied to everything shown on the LEDs:
+//   color:gamma:<gamma>          e.g. 2.2, 1 for none
+//   color:brightness:<0-255>
+//   color:balance:<r>:<g>:<b>    channel scales, 0-255
+//   color:reset                  no correction
+class ColorCommand : public Command {
+ public:
+  ColorCommand(ColorPipeline& pipeline) : Command("color"), pipeline_(pipeline) {}
+
+  void process(std::string_view args) override;
+
+ private:
+  ColorPipeline& pipeline_;
+
+  // Parse the i-th colon separated 0-255 value of args
+  bool parse_byte(std::string_view args, size_t index, uint8_t& value);
+};
@@ -0,0 +1,31 @@
+#include "color_pipeline.h"
+
+#include <math.h>
+
+void ColorPipeline::configure(const Settings& settings) {
+  settings_ = settings;
+
+  uint8_t next = switch_.writable();
+  Lut& lut = tables_[next];
+  for (int i = 0; i < 256; ++i) {
+    float level = powf(i / 255.0f, settings.gamma) * settings.brightness;
+    for (int c = 0; c < 3; ++c) {
+      lut[c][i] = lroundf(level * settings.balance[c] / 255.0f);
+    }
+  }
+
+  switch_.publish(next);
+}
+
+uint32_t ColorPipeline::apply(CRGB* out, const CRGB* in, const uint16_t* map,
+                              size_t count) {
+  uint32_t version;
+  const Lut& lut = tables_[switch_.acquire(version)];
+  for (size_t i = 0; i < count; ++i) {
+    CRGB& led = out[map[i]];
+    led.r = lut[0][in[i].r];
+    led.g = lut[1][in[i].g];
+    led.b = lut[2][in[i].b];
+  }
+  return version;
+}
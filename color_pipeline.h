@@ -0,0 +1,53 @@
+#pragma once
+
+#include <FastLED.h>
+#include <stdint.h>
+
+#include <array>
+
+#include "table_switch.h"
+
+// Colour correction applied as LEDs are copied to the strip: gamma, global
+// brightness and a per-channel white balance, folded into one 256 entry
+// lookup table per channel so each pixel costs one lookup per channel.
+//
+// configure() runs on core 0 and apply() on core 1; the tables are handed over
+// through a TableSwitch, so apply() never sees a half built table.
+class ColorPipeline {
+ public:
+  struct Settings {
+    float gamma = 1.0f;
+    uint8_t brightness = 255;
+    uint8_t balance[3] = {255, 255, 255};  // Scale of r, g and b
+  };
+
+  ColorPipeline() = default;
+
+  // Build tables for settings and make them current. Core 0 only.
+  void configure(const Settings& settings);
+  const Settings& settings() const { return settings_; }
+
+  // Copy count LEDs from in to out through the current tables, LED i going to
+  // out[map[i]]. Returns the version of the tables used. Core 1 only.
+  uint32_t apply(CRGB* out, const CRGB* in, const uint16_t* map, size_t count);
+
+  // Incremented whenever configure() switches tables
+  uint32_t version() const { return switch_.version(); }
+
+ private:
+  using Lut = std::array<std::array<uint8_t, 256>, 3>;
+
+  // The identity, so the pipeline starts out as a plain copy
+  static constexpr Lut kIdentity = [] {
+    Lut lut{};
+    for (auto& channel : lut) {
+      for (int i = 0; i < 256; ++i) channel[i] = i;
+    }
+    return lut;
+  }();
+
+  Lut tables_[3] = {kIdentity, kIdentity, kIdentity};
+  TableSwitch switch_;
+
+  Settings settings_;  // Core 0 only
+};
@@ -6,19 +6,235 @@
 #include <algorithm>
 #include <string_view>
 
+#include "crc16.h"
+
+namespace {
+
+// Adds the time spent in a scope to a running total
+class ScopedTimer {
+ public:
+  explicit ScopedTimer(uint32_t& total_us)
+      : total_us_(total_us), start_(micros()) {}
+  ~ScopedTimer() { total_us_ += micros() - start_; }
+
+ private:
+  uint32_t& total_us_;
+  uint32_t start_;
+};
+
+}  // namespace
+
+CommandProcessor::CommandProcessor(std::span<Command*> commands, Print& log)
+    : commands_(commands), log_(log) {
+  if (commands_.size() > CommandTable::kMaxCommands) {
+    log_.println("Too many commands, ignoring the last ones");
+    commands_ = commands_.first(CommandTable::kMaxCommands);
+  }
+
+  std::array<std::string_view, CommandTable::kMaxCommands> prefixes;
+  for (size_t i = 0; i < commands_.size(); ++i) {
+    prefixes[i] = commands_[i]->prefix();
+  }
+  by_initial_ = BuildCommandTable(std::span(prefixes.data(), commands_.size()));
+
+  // Walk backwards so the first registered command wins when frame types
+  // clash, as the prefix chains keep it first when prefixes do
+  for (auto it = commands_.rbegin(); it != commands_.rend(); ++it) {
+    Command* cmd = *it;
+    if (cmd->frame_type() != kFrameNone) {
+      by_frame_type_[cmd->frame_type()] = cmd;
+    }
+  }
+}
+
 void CommandProcessor::process_char(char c) {
+  check_frame_timeout();
+  handle_char(c);
+}
+
+void CommandProcessor::check_frame_timeout() {
+  uint32_t now = micros();
+  if (frame_state_ != FrameState::kIdle &&
+      now - last_input_us_ > FRAME_TIMEOUT_US) {
+    ++frame_timeouts_;
+    if (frame_command_) {
+      {
+        ScopedTimer timer(active_us_);
+        frame_command_->end_frame(false);
+      }
+      frame_command_->latency().record(active_us_);
+    }
+    frame_command_ = nullptr;
+    frame_state_ = FrameState::kIdle;
+  }
+  last_input_us_ = now;
+}
+
+void CommandProcessor::handle_char(char c) {
+  if (frame_state_ != FrameState::kIdle) {
+    process_frame_byte(c);
+    return;
+  }
+
+  if (streaming_) {
+    if (c == '\n') {
+      {
+        ScopedTimer timer(active_us_);
+        streaming_->end_stream();
+      }
+      streaming_->latency().record(active_us_);
+      streaming_ = nullptr;
+    } else {
+      ScopedTimer timer(active_us_);
+      streaming_->stream(std::string_view(&c, 1));
+    }
+    return;
+  }
+
+  if (buffer_pos_ == 0 && static_cast<uint8_t>(c) == kFrameSync) {
+    frame_state_ = FrameState::kType;
+    frame_crc_ = kCrc16Init;
+    return;
+  }
+
   if (c == '\n') {
+    if (truncated_) {
+      ++lines_truncated_;
+      truncated_ = false;
+    }
     // Process the complete command
     process_command(std::string_view(buffer_.data(), buffer_pos_));
     buffer_pos_ = 0;
   } else if (buffer_pos_ < buffer_.size()) {
+    if (c == ':') {
+      // Hand the rest of the line to a streaming command as it arrives
+      Command* cmd =
+          find_streaming_command(std::string_view(buffer_.data(), buffer_pos_));
+      if (cmd) {
+        streaming_ = cmd;
+        buffer_pos_ = 0;
+        active_us_ = 0;
+        ScopedTimer timer(active_us_);
+        cmd->begin_stream();
+        return;
+      }
+    }
     buffer_[buffer_pos_++] = c;
+  } else {
+    truncated_ = true;
+  }
+}
+
+void CommandProcessor::process_chars(std::string_view chars) {
+  if (chars.empty()) return;
+  check_frame_timeout();
+  while (!chars.empty()) {
+    if (frame_state_ == FrameState::kPayload) {
+      size_t count = std::min<size_t>(chars.size(), frame_remaining_);
+      std::span<const uint8_t> payload(
+          reinterpret_cast<const uint8_t*>(chars.data()), count);
+      for (uint8_t byte : payload) {
+        frame_crc_ = Crc16Update(frame_crc_, byte);
+      }
+      if (frame_command_) {
+        ScopedTimer timer(active_us_);
+        frame_command_->frame_data(payload);
+      }
+      frame_remaining_ -= count;
+      if (frame_remaining_ == 0) frame_state_ = FrameState::kCrcLow;
+      chars.remove_prefix(count);
+    } else if (streaming_ && frame_state_ == FrameState::kIdle &&
+               chars.front() != '\n') {
+      // Everything up to the newline belongs to the streaming command
+      size_t count = std::min(chars.find('\n'), chars.size());
+      {
+        ScopedTimer timer(active_us_);
+        streaming_->stream(chars.substr(0, count));
+      }
+      chars.remove_prefix(count);
+    } else {
+      handle_char(chars.front());
+      chars.remove_prefix(1);
+    }
+  }
+}
+
+Command* CommandProcessor::find_streaming_command(std::string_view prefix) {
+  if (prefix.empty()) return nullptr;
+  for (uint8_t i = by_initial_.first[static_cast<uint8_t>(prefix[0])];
+       i != CommandTable::kNoCommand; i = by_initial_.next[i]) {
+    Command* cmd = commands_[i];
+    if (cmd->prefix() == prefix) {
+      // The first command with this prefix is the one process_command() would
+      // dispatch to, so only stream if that one is a streaming command.
+      return cmd->streaming() ? cmd : nullptr;
+    }
+  }
+  return nullptr;
+}
+
+void CommandProcessor::process_frame_byte(uint8_t byte) {
+  switch (frame_state_) {
+    case FrameState::kIdle:
+      break;
+    case FrameState::kType:
+      frame_command_ = by_frame_type_[byte];
+      frame_crc_ = Crc16Update(frame_crc_, byte);
+      frame_state_ = FrameState::kLengthLow;
+      break;
+    case FrameState::kLengthLow:
+      frame_remaining_ = byte;
+      frame_crc_ = Crc16Update(frame_crc_, byte);
+      frame_state_ = FrameState::kLengthHigh;
+      break;
+    case FrameState::kLengthHigh:
+      frame_remaining_ |= byte << 8;
+      frame_crc_ = Crc16Update(frame_crc_, byte);
+      active_us_ = 0;
+      if (frame_command_) {
+        ScopedTimer timer(active_us_);
+        frame_command_->begin_frame(frame_remaining_);
+      }
+      frame_state_ = frame_remaining_ > 0 ? FrameState::kPayload
+                                          : FrameState::kCrcLow;
+      break;
+    case FrameState::kPayload:
+      frame_crc_ = Crc16Update(frame_crc_, byte);
+      if (frame_command_) {
+        ScopedTimer timer(active_us_);
+        frame_command_->frame_data({&byte, 1});
+      }
+      if (--frame_remaining_ == 0) frame_state_ = FrameState::kCrcLow;
+      break;
+    case FrameState::kCrcLow:
+      received_crc_ = byte;
+      frame_state_ = FrameState::kCrcHigh;
+      break;
+    case FrameState::kCrcHigh:
+      received_crc_ |= byte << 8;
+      if (received_crc_ != frame_crc_) ++frame_crc_errors_;
+      if (frame_command_) {
+        {
+          ScopedTimer timer(active_us_);
+          frame_command_->end_frame(received_crc_ == frame_crc_);
+        }
+        frame_command_->latency().record(active_us_);
+      }
+      frame_command_ = nullptr;
+      frame_state_ = FrameState::kIdle;
+      break;
   }
 }
 
 void CommandProcessor::process_command(std::string_view line) {
-  // Find matching command by checking prefix substring
-  for (Command* cmd : commands_) {
+  // Find matching command by checking prefix substring, among the commands
+  // whose prefix starts with the same byte as the line
+  uint8_t first = line.empty()
+                      ? CommandTable::kNoCommand
+                      : by_initial_.first[static_cast<uint8_t>(line[0])];
+  for (uint8_t i = first; i != CommandTable::kNoCommand;
+       i = by_initial_.next[i]) {
+    Command* cmd = commands_[i];
     std::string_view cmd_prefix = cmd->prefix();
     if (line.size() >= cmd_prefix.size() &&
         line.substr(0, cmd_prefix.size()) == cmd_prefix) {
@@ -32,15 +248,16 @@ void CommandProcessor::process_command(std::string_view line) {
           continue;
         }
       }
+      uint32_t start = micros();
       cmd->process(args);
+      cmd->latency().record(micros() - start);
       return;
     }
   }
 
   // No matching command found
-  Serial.write("Unknown command: ", 16);
-  for (char c : line) {
-    Serial.write(c);
-  }
-  Serial.write('\n');
+  ++unknown_commands_;
+  log_.write("Unknown command: ", 17);
+  log_.write(line.data(), line.size());
+  log_.write('\n');
 }
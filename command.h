@@ -1,38 +1,184 @@
 #pragma once
 
+#include <Arduino.h>
+#include <stdint.h>
+
+#include <algorithm>
 #include <array>
 #include <span>
 #include <string_view>
 
+#include "latency_histogram.h"
+
+// Binary frames start with kFrameSync at the beginning of a line, followed by
+// a FrameType byte, a little-endian uint16_t payload length, the payload and a
+// little-endian CRC-16 (see crc16.h) over type, length and payload.
+constexpr uint8_t kFrameSync = 0xA5;
+
+enum FrameType : uint8_t {
+  kFrameNone = 0x00,
+  kFrameLed = 0x01,            // Raw LedCommand payload
+  kFrameLedSeq = 0x02,         // Sequence number and LedCommand payload
+  kFrameLedTagged = 0x03,      // Frame ID and LedCommand payload to stage
+  kFrameLedTransition = 0x04,  // Keyframe, see TransitionCommand
+};
+
 class Command {
  public:
-  explicit Command(std::string_view prefix) : prefix_(prefix) {}
+  explicit Command(std::string_view prefix, bool streaming = false,
+                   FrameType frame_type = kFrameNone)
+      : prefix_(prefix), streaming_(streaming), frame_type_(frame_type) {}
   virtual ~Command() = default;
 
   // Process the command arguments
   virtual void process(std::string_view args) = 0;
 
+  // Streaming commands receive their arguments as they arrive instead of as
+  // one buffered line, so they are not limited by the line buffer size.
+  // begin_stream() is called once "prefix:" has been seen, stream() for each
+  // chunk of arguments and end_stream() at the terminating newline.
+  virtual void begin_stream() {}
+  virtual void stream(std::string_view chunk) {}
+  virtual void end_stream() {}
+
+  // Binary frames of frame_type() are delivered the same way: begin_frame()
+  // with the payload length, frame_data() for each chunk of payload and
+  // end_frame() once the CRC has been checked.
+  virtual void begin_frame(size_t length) {}
+  virtual void frame_data(std::span<const uint8_t> data) {}
+  virtual void end_frame(bool valid) {}
+
   // Get the command prefix
   std::string_view prefix() const { return prefix_; }
 
+  // Whether arguments are delivered through the streaming interface
+  bool streaming() const { return streaming_; }
+
+  // Binary frame type handled by this command, or kFrameNone
+  FrameType frame_type() const { return frame_type_; }
+
+  // Time spent handling each command line or frame, recorded by
+  // CommandProcessor
+  LatencyHistogram& latency() { return latency_; }
+  const LatencyHistogram& latency() const { return latency_; }
+
  private:
   std::string_view prefix_;
+  bool streaming_;
+  FrameType frame_type_;
+  LatencyHistogram latency_;
 };
 
+// First-byte dispatch table over a list of command prefixes, by registration
+// index: first[b] is the first prefix starting with byte b, and next[i] the
+// one after prefix i with the same first byte, in registration order.
+// kNoCommand ends a chain.
+struct CommandTable {
+  static constexpr size_t kMaxCommands = 32;
+  static constexpr uint8_t kNoCommand = 0xFF;
+
+  std::array<uint8_t, 256> first;
+  std::array<uint8_t, kMaxCommands> next;
+};
+
+// Build the CommandTable for prefixes, at compile time if they are constants.
+// Prefixes past kMaxCommands and empty ones are left out.
+constexpr CommandTable BuildCommandTable(
+    std::span<const std::string_view> prefixes) {
+  CommandTable table{};
+  table.first.fill(CommandTable::kNoCommand);
+  table.next.fill(CommandTable::kNoCommand);
+  size_t count = std::min(prefixes.size(), CommandTable::kMaxCommands);
+  // Walk backwards so each chain ends up in registration order
+  for (size_t i = count; i-- > 0;) {
+    if (prefixes[i].empty()) continue;
+    uint8_t& head = table.first[static_cast<uint8_t>(prefixes[i][0])];
+    table.next[i] = head;
+    head = i;
+  }
+  return table;
+}
+
 class CommandProcessor {
  public:
-  // Constructor takes a span of commands to process
-  explicit CommandProcessor(std::span<Command*> commands)
-      : commands_(commands) {}
+  // A binary frame whose next byte has not arrived within this time is
+  // abandoned, so a host that stops mid-frame (e.g. on reconnecting) does not
+  // leave the rest of its frame length swallowing later commands
+  static constexpr uint32_t FRAME_TIMEOUT_US = 250000;
+
+  // Constructor takes a span of commands to process and the stream that
+  // diagnostics such as unknown commands are reported to. Only the first
+  // CommandTable::kMaxCommands commands are dispatched to.
+  CommandProcessor(std::span<Command*> commands, Print& log);
 
   // Process a single character
   void process_char(char c);
 
+  // Process a block of received characters. Streamed arguments and binary
+  // frame payloads are handed to their command in as few chunks as possible.
+  void process_chars(std::string_view chars);
+
+  std::span<Command* const> commands() const { return commands_; }
+
+  // Input error counters
+  uint32_t lines_truncated() const { return lines_truncated_; }
+  uint32_t unknown_commands() const { return unknown_commands_; }
+  uint32_t frame_crc_errors() const { return frame_crc_errors_; }
+  uint32_t frame_timeouts() const { return frame_timeouts_; }
+
  private:
   std::span<Command*> commands_;
+  Print& log_;
+
+  // Dispatch tables built once by the constructor, so that a line or frame
+  // only looks at the commands that can match it instead of every command
+  CommandTable by_initial_;
+  std::array<Command*, 256> by_frame_type_{};
+
   std::array<char, 256> buffer_;
   size_t buffer_pos_ = 0;
+  bool truncated_ = false;
+
+  uint32_t lines_truncated_ = 0;
+  uint32_t unknown_commands_ = 0;
+  uint32_t frame_crc_errors_ = 0;
+  uint32_t frame_timeouts_ = 0;
+
+  // Time spent so far in the streaming or frame command being handled
+  uint32_t active_us_ = 0;
+
+  // Command currently receiving streamed arguments, if any
+  Command* streaming_ = nullptr;
+
+  // Binary frame parser state
+  enum class FrameState : uint8_t {
+    kIdle,
+    kType,
+    kLengthLow,
+    kLengthHigh,
+    kPayload,
+    kCrcLow,
+    kCrcHigh,
+  };
+  FrameState frame_state_ = FrameState::kIdle;
+  Command* frame_command_ = nullptr;
+  uint16_t frame_remaining_ = 0;
+  uint16_t frame_crc_ = 0;
+  uint16_t received_crc_ = 0;
+  uint32_t last_input_us_ = 0;
+
+  // Abandon a binary frame that has stalled for FRAME_TIMEOUT_US
+  void check_frame_timeout();
+
+  // process_char() without the frame timeout check
+  void handle_char(char c);
+
+  // Process one byte of a binary frame
+  void process_frame_byte(uint8_t byte);
 
   // Process a complete command line
   void process_command(std::string_view line);
+
+  // Find a streaming command whose prefix is exactly `prefix`
+  Command* find_streaming_command(std::string_view prefix);
 };
@@ -5,13 +5,20 @@
 #include <string_view>
 
 #include "command.h"
+#include "geometry.h"
+#include "tx_queue.h"
 
+// "?" replies with the LED layout: the geometry, the number of LEDs and the
+// number of parallel output lanes they are split between
 class ConfigCommand : public Command {
  public:
-  ConfigCommand(size_t num_leds) : Command("?"), num_leds_(num_leds) {}
+  ConfigCommand(const Geometry& geometry, size_t lanes, TxQueue& tx)
+      : Command("?"), geometry_(geometry), lanes_(lanes), tx_(tx) {}
 
   void process(std::string_view args) override;
 
  private:
-  size_t num_leds_;
+  const Geometry& geometry_;
+  size_t lanes_;
+  TxQueue& tx_;
 };
@@ -2,43 +2,236 @@ import asyncio
 import socket
 import json
 import base64
-import subprocess
-import platform
+import binascii
+import logging
+
+log = logging.getLogger(__name__)
 
 CONTROLLER_PORT = 51333
 ENUM_COMMAND = b"enum\n"
 BUTTON_TIMEOUT = 0.1
 CONNECTION_TIMEOUT = 2.0
-PING_TIMEOUT = 1.0  # seconds
+RECONF_TIMEOUT = 10.0  # Longest a CH9121 reconfiguration and reset takes
+RECONF_POLL = 0.5  # Interval of reconf status requests once it has started
+# Message kinds of which only the latest queued one is worth sending
+COALESCED_KINDS = ("led", "transition", "backlight", "fx")
+
+# Binary frame protocol, see command.h in the firmware
+FRAME_SYNC = 0xA5
+FRAME_LED = 0x01
+FRAME_LED_SEQ = 0x02
+FRAME_LED_TAGGED = 0x03
+FRAME_LED_TRANSITION = 0x04
+MAX_FRAME_PAYLOAD = 0xFFFF
+FRAME_OVERHEAD = 6  # Sync, type, length and CRC around each payload
+# Largest datagram the CH9121 takes without IP fragmentation. A full frame of
+# up to 487 LEDs fits in one; frames that do not fit raise ValueError.
+MAX_DATAGRAM = 1472
+
+
+def encode_frame(frame_type, payload):
+    """Wrap payload in a binary frame: sync, type, length, payload, CRC-16."""
+    if len(payload) > MAX_FRAME_PAYLOAD:
+        raise ValueError(f"Frame payload too long: {len(payload)} bytes")
+    header = bytes([frame_type, len(payload) & 0xFF, (len(payload) >> 8) & 0xFF])
+    crc = binascii.crc_hqx(header + payload, 0xFFFF)
+    return bytes([FRAME_SYNC]) + header + payload + bytes([crc & 0xFF, (crc >> 8) & 0xFF])
+
+
+# LED payload formats, see led_command.h in the firmware
+LED_PATCH_FRAME = 0xFFFF
+LED_OP_SET = 0x01
+LED_OP_FILL = 0x02
+LED_OP_RUNS = 0x03
+MAX_PATCH_GAP = 1  # Unchanged LEDs worth resending to avoid a new record
+
+# Keyframe easing curves, see EffectEngine::Easing in the firmware
+EASE_LINEAR = 0
+EASE_IN_OUT_QUAD = 1
+EASE_IN_OUT_CUBIC = 2
+
+
+def _u16(value):
+    return bytes([value & 0xFF, (value >> 8) & 0xFF])
+
+
+def _runs(colors):
+    """Split colors into [color, length] runs of identical colors."""
+    runs = []
+    for color in colors:
+        if runs and runs[-1][0] == color:
+            runs[-1][1] += 1
+        else:
+            runs.append([color, 1])
+    return runs
+
+
+def _encode_set(start, colors):
+    out = bytearray()
+    for i in range(0, len(colors), 255):
+        chunk = colors[i : i + 255]
+        out += bytes([LED_OP_SET]) + _u16(start + i) + bytes([len(chunk)])
+        for color in chunk:
+            out += bytes(color)
+    return bytes(out)
+
+
+def _encode_runs(start, colors):
+    out = bytearray()
+    pending = []  # (length, color) runs of the current OP_RUNS record
+    pending_start = start
+
+    def flush():
+        if pending:
+            out.extend(bytes([LED_OP_RUNS]) + _u16(pending_start) + bytes([len(pending)]))
+            for length, color in pending:
+                out.extend(bytes([length]) + bytes(color))
+            pending.clear()
+
+    index = start
+    for color, length in _runs(colors):
+        if length > 255:
+            flush()
+            out.extend(bytes([LED_OP_FILL]) + _u16(index) + _u16(length) + bytes(color))
+        else:
+            if not pending:
+                pending_start = index
+            pending.append((length, color))
+            if len(pending) == 255:
+                flush()
+        index += length
+    flush()
+    return bytes(out)
+
+
+def _encode_span(start, colors):
+    """Encode one span of LEDs with whichever record type is smaller."""
+    return min(_encode_set(start, colors), _encode_runs(start, colors), key=len)
+
+
+def encode_leds(colors, previous=None):
+    """Return the smallest LED payload that turns previous into colors.
+
+    Candidates are a full frame, a run-length encoded patch frame and, if the
+    controller is known to show previous (same length), a patch frame with
+    only the LEDs that changed.
+    """
+    full = bytearray(_u16(len(colors)))
+    for color in colors:
+        full += bytes(color)
+    candidates = [bytes(full)]
+    if colors:
+        candidates.append(_u16(LED_PATCH_FRAME) + _encode_runs(0, colors))
+    if previous is not None and len(previous) == len(colors):
+        delta = bytearray(_u16(LED_PATCH_FRAME))
+        i = 0
+        while i < len(colors):
+            if colors[i] == previous[i]:
+                i += 1
+                continue
+            end = i + 1
+            while end < len(colors):
+                if colors[end] != previous[end]:
+                    end += 1
+                    continue
+                gap = end
+                while gap < len(colors) and colors[gap] == previous[gap]:
+                    gap += 1
+                if gap == len(colors) or gap - end > MAX_PATCH_GAP:
+                    break
+                end = gap
+            delta += _encode_span(i, colors[i:end])
+            i = end
+        candidates.append(bytes(delta))
+    return min(candidates, key=len)
 
 
 class ControllerState:
-    def __init__(self, ip, dip, loop):
+    def __init__(
+        self,
+        ip,
+        dip,
+        loop,
+        binary_frames=True,
+        window=None,
+        transport="tcp",
+        coalesce=True,
+        sock=None,
+        receive_buffer=b"",
+        port=CONTROLLER_PORT,
+    ):
         self.ip = ip
+        self.port = port
         self.dip = dip
         self.loop = loop
+        self.binary_frames = binary_frames  # Send LED data as binary frames
+        # Drop queued messages of COALESCED_KINDS superseded by a newer one
+        self.coalesce = coalesce
+        # "tcp", or "udp" for a controller whose CH9121 is in UDP server mode.
+        # Over UDP every message is one datagram and LED frames are sequenced,
+        # self-contained frames that the controller drops if they arrive late.
+        self.transport = transport
+        self._seq = 0
+        # Bytes the controller can buffer, None if it does not send credits.
+        # Lost datagrams would never be credited, so UDP sends without a window.
+        self.window = window if transport == "tcp" else None
+        self._in_flight = 0
+        self._credit = asyncio.Condition()
         self.button_callback = None
+        self._reconf_replies = None  # Queue of reconf replies during reconfigure()
+        # Cleared while reconfigure() holds back other messages
+        self._sending = asyncio.Event()
+        self._sending.set()
         self._listen_task = None
         self._socket = None
         self._connected = False
         self._receive_buffer = b""
+        self._last_leds = None  # LED colors the controller is known to show
+        # Messages queued for the next write as (kind, message) pairs, and the
+        # future that write resolves
+        self._outbox = []
+        self._flushed = None
+        self._write_lock = asyncio.Lock()
+        self._connect_lock = asyncio.Lock()
+        if sock:
+            # Adopt the connection enumeration opened, with what it read ahead
+            self._attach(sock)
+            self._receive_buffer = receive_buffer
 
     async def connect(self):
+        # The receive path and a write can both find the connection gone
+        async with self._connect_lock:
+            return await self._connect()
+
+    async def _connect(self):
         if self._connected:
             return True
         try:
-            self._socket = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
-            self._socket.settimeout(CONNECTION_TIMEOUT)
-            await self.loop.sock_connect(self._socket, (self.ip, CONTROLLER_PORT))
+            kind = socket.SOCK_DGRAM if self.transport == "udp" else socket.SOCK_STREAM
+            self._socket = socket.socket(socket.AF_INET, kind)
             self._socket.setblocking(False)
-            self._connected = True
-            self._receive_buffer = b""  # Clear buffer on new connection
+            await asyncio.wait_for(
+                self.loop.sock_connect(self._socket, (self.ip, self.port)),
+                CONNECTION_TIMEOUT,
+            )
+            self._attach(self._socket)
             return True
         except Exception as e:
             print(f"Failed to connect to {self.ip}: {e}")
+            self._socket.close()
+            self._socket = None
             self._connected = False
             return False
 
+    def _attach(self, sock):
+        sock.setblocking(False)
+        self._socket = sock
+        self._connected = True
+        self._receive_buffer = b""  # Clear buffer on new connection
+        if self.window and not self._listen_task:
+            # Credits arrive on the receive path, so it must be running
+            self._listen_task = self.loop.create_task(self._listen_buttons())
+
     def disconnect(self):
         if self._socket:
             try:
@@ -48,6 +241,9 @@ class ControllerState:
         self._socket = None
         self._connected = False
         self._receive_buffer = b""  # Clear buffer on disconnect
+        self._last_leds = None
+        self._in_flight = 0
+        self.loop.create_task(self._release_credit(0))
 
     async def set_lcd(self, x, y, text):
         msg = f"lcd:{x}:{y}:{text}\n".encode()
@@ -61,33 +257,245 @@ class ControllerState:
     async def set_backlights(self, states):
         payload = ":".join(["1" if s else "0" for s in states])
         msg = f"backlight:{payload}\n".encode()
-        await self._send(msg)
+        await self._send(msg, kind="backlight")
+
+    async def set_leds(self, rgb_values, frame_id=None):
+        """Set LED colors from a list of (r,g,b) tuples.
+
+        Sends a full frame, or a patch frame against the last colors sent when
+        that is smaller. With a frame_id (0-65535) the frame is only staged,
+        and shown by present(frame_id). Over UDP, raises ValueError if the
+        frame does not fit in a datagram (see MAX_DATAGRAM).
+        """
+        colors = [(r & 0xFF, g & 0xFF, b & 0xFF) for r, g, b in rgb_values]
+        # Over TCP, encoded when the queue is written, so a patch is made
+        # against the frame that was actually sent before it. Over UDP, frames
+        # too large for a datagram raise ValueError. A staged frame must not be
+        # coalesced away before its present.
+        if frame_id is None:
+            payload = self._datagram_payload(colors, _u16(self._seq))
+            await self._send((colors, None, b"", payload), kind="led")
+        else:
+            header = _u16(frame_id)
+            payload = self._datagram_payload(colors, header)
+            await self._send((colors, FRAME_LED_TAGGED, header, payload), kind="staged_led")
+
+    async def transition_leds(self, rgb_values, duration_ms, easing=EASE_LINEAR):
+        """Blend the LEDs to a keyframe of (r,g,b) tuples on the controller.
+
+        The controller interpolates from its current LEDs over duration_ms
+        (up to 65535) with one of the EASE_* curves.
+        """
+        colors = [(r & 0xFF, g & 0xFF, b & 0xFF) for r, g, b in rgb_values]
+        header = _u16(min(duration_ms, 0xFFFF)) + bytes([easing])
+        payload = self._datagram_payload(colors, header)
+        # Its own kind, so a keyframe and a plain frame never replace each other
+        await self._send((colors, FRAME_LED_TRANSITION, header, payload), kind="transition")
+
+    async def set_effect(self, name, *params):
+        """Run an effect on the controller, e.g. set_effect("hue", 4000, 256).
+
+        See fx_command.h in the firmware for the effects and their parameters;
+        colors are passed as three separate r, g, b parameters.
+        """
+        msg = ":".join(["fx", name] + [str(int(p)) for p in params]) + "\n"
+        await self._send(msg.encode(), kind="fx")
+
+    async def set_color_correction(self, gamma=None, brightness=None, balance=None):
+        """Set the controller's colour correction, leaving settings not given.
+
+        The controller corrects every LED as it is shown, so colors sent by
+        set_leds() and effects stay linear.
+        """
+        lines = []
+        if gamma is not None:
+            lines.append(f"color:gamma:{gamma:g}\n")
+        if brightness is not None:
+            lines.append(f"color:brightness:{int(brightness)}\n")
+        if balance is not None:
+            r, g, b = balance
+            lines.append(f"color:balance:{int(r)}:{int(g)}:{int(b)}\n")
+        await self._send("".join(lines).encode())
+
+    async def set_geometry(self, cube_size=None, serpentine=False):
+        """Describe the LED layout so frames can be sent in logical order.
+
+        With a cube_size of n, LED x + n * (y + n * z) of a frame is cube LED
+        (x, y, z); without one the LEDs are a plain strip.
+        """
+        if cube_size is None:
+            msg = "geom:linear\n"
+        else:
+            msg = f"geom:cube:{int(cube_size)}{':serpentine' if serpentine else ''}\n"
+        await self._send(msg.encode())
 
-    async def set_leds(self, rgb_values):
-        """Set LED colors from a list of (r,g,b) tuples."""
-        # Create payload: [num_leds (16-bit LE), r0,g0,b0, r1,g1,b1, ...]
-        num_leds = len(rgb_values)
-        payload = bytearray([num_leds & 0xFF, (num_leds >> 8) & 0xFF])
-        for r, g, b in rgb_values:
-            payload.extend([r & 0xFF, g & 0xFF, b & 0xFF])
-        msg = f"led:{base64.b64encode(bytes(payload)).decode()}\n".encode()
+    async def present(self, frame_id, delay_ms=0):
+        """Show the frame staged with frame_id, delay_ms after it arrives."""
+        if delay_ms:
+            msg = f"present:{frame_id}:{delay_ms}\n".encode()
+        else:
+            msg = f"present:{frame_id}\n".encode()
         await self._send(msg)
 
+    def _datagram_payload(self, colors, header):
+        """Over UDP, return the LED payload for colors, else None.
+
+        The previous datagram may have been lost, so frames never patch it and
+        can be encoded before they are queued. Raises ValueError if the frame,
+        with header before the payload, does not fit in a datagram.
+        """
+        if self.transport != "udp":
+            return None
+        payload = encode_leds(colors)
+        size = FRAME_OVERHEAD + len(header) + len(payload)
+        if size > MAX_DATAGRAM:
+            raise ValueError(f"LED frame too large for a datagram: {size} bytes")
+        return payload
+
+    def _encode_leds(self, colors, frame_type, header, payload):
+        """Return the message for an LED frame.
+
+        frame_type is None for a plain frame, or a frame type whose payload is
+        header followed by the LED payload. payload is the LED payload if it was
+        encoded when the frame was queued, as over UDP.
+        """
+        if frame_type is not None:
+            if payload is None:
+                payload = encode_leds(colors, self._last_leds)
+                self._last_leds = colors
+            return encode_frame(frame_type, header + payload)
+        if payload is not None:
+            self._seq = (self._seq + 1) & 0xFFFF
+            return encode_frame(FRAME_LED_SEQ, _u16(self._seq) + payload)
+        payload = encode_leds(colors, self._last_leds)
+        self._last_leds = colors
+        if self.binary_frames:
+            return encode_frame(FRAME_LED, payload)
+        return f"led:{base64.b64encode(payload).decode()}\n".encode()
+
+    async def reconfigure(self, target_ip, target_port, timeout=RECONF_TIMEOUT):
+        """Point the controller's CH9121 at target_ip:target_port.
+
+        Saving the new settings resets the module, which drops the connection
+        and can lose the controller's final reply, so once the controller has
+        answered "started" this asks for the result again every RECONF_POLL
+        seconds, over the connection the receive path reopens. Returns that
+        {"reconf": "done" or "failed", "written": fields} reply, or None if
+        there was none within timeout seconds.
+
+        The controller discards whatever arrives while its CH9121 is in
+        configuration mode, so other messages are held back until then and
+        sent (coalesced) afterwards.
+        """
+        self._reconf_replies = asyncio.Queue()
+        if not self._listen_task:
+            # Replies arrive on the receive path, so it must be running
+            self._listen_task = self.loop.create_task(self._listen_buttons())
+        try:
+            return await asyncio.wait_for(self._reconfigure(target_ip, target_port), timeout)
+        except asyncio.TimeoutError:
+            print(f"Reconfiguration of {self.ip} timed out")
+            return None
+        finally:
+            self._reconf_replies = None
+            self._sending.set()
+
+    async def _reconfigure(self, target_ip, target_port):
+        await self._send(f"reconf:{target_ip}:{int(target_port)}\n".encode())
+        self._sending.clear()
+        while (await self._reconf_replies.get())["reconf"] != "started":
+            pass
+        while True:
+            try:
+                reply = await asyncio.wait_for(self._reconf_replies.get(), RECONF_POLL)
+            except asyncio.TimeoutError:
+                # Leave reconnecting to the receive path
+                if self._connected:
+                    async with self._write_lock:
+                        await self._write([b"reconf:status\n"])
+                continue
+            if reply["reconf"] in ("done", "failed"):
+                return reply
+
     def register_button_callback(self, callback):
         self.button_callback = callback
         if not self._listen_task:
             self._listen_task = self.loop.create_task(self._listen_buttons())
 
-    async def _send(self, msg):
+    async def _wait_for_window(self, size):
+        """Wait until the controller has room for size more bytes.
+
+        A message larger than the whole window is sent once nothing else is
+        in flight.
+        """
+        async with self._credit:
+            await self._credit.wait_for(
+                lambda: self._in_flight == 0 or self._in_flight + size <= self.window
+            )
+            self._in_flight += size
+
+    async def _release_credit(self, credit):
+        async with self._credit:
+            self._in_flight = max(0, self._in_flight - credit)
+            self._credit.notify_all()
+
+    async def _send(self, msg, kind=None):
+        """Queue msg and wait until it has been written.
+
+        Messages queued in the same event loop tick go out in one write. With
+        coalescing on, a message of one of COALESCED_KINDS replaces any queued
+        message of the same kind.
+        """
+        if self.coalesce and kind in COALESCED_KINDS:
+            self._outbox = [entry for entry in self._outbox if entry[0] != kind]
+        self._outbox.append((kind, msg))
+        if self._flushed is None:
+            self._flushed = self.loop.create_future()
+            self.loop.create_task(self._flush())
+        await asyncio.shield(self._flushed)
+
+    async def _flush(self):
+        """Write everything queued so far, in order."""
+        flushed = self._flushed
+        try:
+            await self._sending.wait()
+            async with self._write_lock:
+                outbox, self._outbox, self._flushed = self._outbox, [], None
+                messages = []
+                for kind, msg in outbox:
+                    if kind in ("led", "staged_led", "transition"):
+                        msg = self._encode_leds(*msg)
+                    elif kind == "fx":
+                        # The effect repaints the LEDs, so the next frame
+                        # cannot be a patch against the last one sent
+                        self._last_leds = None
+                    if msg:
+                        messages.append(msg)
+                await self._write(messages)
+        finally:
+            flushed.set_result(None)
+
+    async def _write(self, messages):
+        if not messages:
+            return
         if not self._connected:
             if not await self.connect():
                 return
-        try:
-            print(f"Sending message to {self.ip}: {msg}")
-            await self.loop.sock_sendall(self._socket, msg)
-        except Exception as e:
-            print(f"Error sending to {self.ip}: {e}")
-            self.disconnect()
+        # A datagram per message over UDP, one write for the batch over TCP
+        chunks = messages if self.transport == "udp" else [b"".join(messages)]
+        for chunk in chunks:
+            if self.window:
+                await self._wait_for_window(len(chunk))
+                if not self._connected:
+                    return
+            if log.isEnabledFor(logging.DEBUG):
+                log.debug("Sending %d messages to %s: %r", len(messages), self.ip, chunk)
+            try:
+                await self.loop.sock_sendall(self._socket, chunk)
+            except Exception as e:
+                print(f"Error sending to {self.ip}: {e}")
+                self.disconnect()
+                return
 
     async def _listen_buttons(self):
         while True:
@@ -97,13 +505,15 @@ class ControllerState:
                     continue
 
             try:
-                data = await self.loop.sock_recv(self._socket, 4096)  # Read up to 4KB
-                if not data:  # Connection closed by remote host
-                    print(f"Connection closed by {self.ip}")
-                    self.disconnect()
-                    continue
+                # Messages read ahead by enumeration come before new data
+                if b"\n" not in self._receive_buffer:
+                    data = await self.loop.sock_recv(self._socket, 4096)  # Read up to 4KB
+                    if not data:  # Connection closed by remote host
+                        print(f"Connection closed by {self.ip}")
+                        self.disconnect()
+                        continue
 
-                self._receive_buffer += data
+                    self._receive_buffer += data
 
                 # Process all complete messages in the buffer
                 while b"\n" in self._receive_buffer:
@@ -113,7 +523,12 @@ class ControllerState:
                         if not msg_str:  # Skip empty lines
                             continue
                         msg = json.loads(msg_str)
-                        if "buttons" in msg and self.button_callback:
+                        if "credit" in msg:
+                            await self._release_credit(msg["credit"])
+                        elif "reconf" in msg:
+                            if self._reconf_replies is not None:
+                                self._reconf_replies.put_nowait(msg)
+                        elif "buttons" in msg and self.button_callback:
                             self.button_callback(msg["buttons"])
                     except json.JSONDecodeError as e:
                         print(f"JSON Decode Error: {e} - Message: {message}")
@@ -138,124 +553,91 @@ class ControllerState:
 
 
 class ControlPort:
-    def __init__(self, base_ip="192.168.0.", start=50, end=65, port=CONTROLLER_PORT, loop=None):
+    def __init__(
+        self,
+        base_ip="192.168.0.",
+        start=50,
+        end=65,
+        port=CONTROLLER_PORT,
+        loop=None,
+        transport="tcp",
+    ):
         self.base_ip = base_ip
         self.start = start
         self.end = end
         self.port = port
+        self.transport = transport  # "tcp" or "udp", see ControllerState
         self.loop = loop or asyncio.get_event_loop()
         self.controllers = {}
 
-    async def ping_host(self, ip):
-        """Ping a host and return True if it responds."""
-        param = "-n" if platform.system().lower() == "windows" else "-c"
-        command = ["ping", param, "1", "-W", str(int(PING_TIMEOUT * 1000)), ip]
-        try:
-            result = await self.loop.run_in_executor(
-                None,
-                lambda: subprocess.run(
-                    command, capture_output=True, text=True, timeout=PING_TIMEOUT
-                ),
-            )
-            return result.returncode == 0
-        except Exception as e:
-            print(f"Error pinging {ip}: {e}")
-            return False
-
-    async def check_port(self, ip):
-        """Check if the port is open using a socket connection."""
-        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
-        sock.settimeout(1.0)  # Short timeout for port check
-        try:
-            result = await self.loop.sock_connect(sock, (ip, self.port))
-            print(f"Port {self.port} is open on {ip}")
-            return True
-        except Exception as e:
-            print(f"Port {self.port} is closed on {ip}: {e}")
-            return False
-        finally:
-            sock.close()
-
-    async def discover_hosts(self):
-        """Discover reachable hosts using ICMP ping and port check."""
-        print("Discovering reachable hosts...")
-        tasks = []
-        for i in range(self.start, self.end + 1):
-            ip = f"{self.base_ip}{i}"
-            tasks.append(self.ping_host(ip))
-
-        results = await asyncio.gather(*tasks)
-        reachable_ips = []
-        for i, is_reachable in enumerate(results):
-            ip = f"{self.base_ip}{i + self.start}"
-            if is_reachable:
-                print(f"Host {ip} is reachable")
-                # Check if the port is open
-                if await self.check_port(ip):
-                    reachable_ips.append(ip)
-            else:
-                print(f"Host {ip} is not reachable")
-        return reachable_ips
-
     async def enumerate(self, timeout=2.0):
-        # First discover reachable hosts
-        reachable_ips = await self.discover_hosts()
-        if not reachable_ips:
-            print("No reachable hosts found")
-            return self.controllers
-
-        # Then try to enumerate only the reachable hosts
-        tasks = []
-        for ip in reachable_ips:
-            tasks.append(self._query_controller(ip, timeout / 2))
+        """Find the controllers on every address from start to end.
 
-        try:
-            results = await asyncio.wait_for(asyncio.gather(*tasks), timeout=timeout)
-        except asyncio.TimeoutError:
-            print("Global enumeration timeout")
-            results = []
+        All addresses are queried at once, each by connecting, sending enum
+        and waiting for the reply, and the whole pass ends after timeout
+        seconds. The connection to each controller found is kept for its
+        ControllerState.
+        """
+        ips = [f"{self.base_ip}{i}" for i in range(self.start, self.end + 1)]
+        results = await asyncio.gather(*[self._query_controller(ip, timeout) for ip in ips])
 
         for result in results:
             if result:
-                ip, dip = result
-                self.controllers[ip] = ControllerState(ip, dip, self.loop)
+                ip, dip, window, sock, buffered = result
+                self.controllers[ip] = ControllerState(
+                    ip,
+                    dip,
+                    self.loop,
+                    window=window,
+                    transport=self.transport,
+                    sock=sock,
+                    receive_buffer=buffered,
+                    port=self.port,
+                )
+        print(f"Found {len(self.controllers)} controllers")
         return self.controllers
 
+    async def present(self, frame_id, delay_ms=0):
+        """Show the frame staged with frame_id on every controller at once."""
+        await asyncio.gather(
+            *[ctrl.present(frame_id, delay_ms) for ctrl in self.controllers.values()]
+        )
+
     async def _query_controller(self, ip, timeout):
-        print(f"\nAttempting to enumerate {ip}:{self.port}")
-        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
-        sock.settimeout(timeout)
+        """Return (ip, dip, window, socket, unread data) if ip is a controller."""
+        kind = socket.SOCK_DGRAM if self.transport == "udp" else socket.SOCK_STREAM
+        sock = socket.socket(socket.AF_INET, kind)
+        sock.setblocking(False)
         try:
-            print(f"1. Connecting to {ip}:{self.port}")
-            await self.loop.sock_connect(sock, (ip, self.port))
-            print("2. Connection successful, setting non-blocking mode")
-            sock.setblocking(False)
-
-            print("3. Sending enum command")
-            await self.loop.sock_sendall(sock, ENUM_COMMAND)
-            print("4. Command sent, waiting for response")
+            msg, buffered = await asyncio.wait_for(self._exchange_enum(sock, ip), timeout)
+        except (asyncio.TimeoutError, OSError) as e:
+            # Most addresses in the range have no controller, so stay quiet
+            log.debug("No controller at %s: %s", ip, e)
+            sock.close()
+            return None
+        except (ValueError, UnicodeDecodeError) as e:
+            print(f"Invalid enum reply from {ip}: {e}")
+            sock.close()
+            return None
 
-            data = await self.loop.sock_recv(sock, 1024)
-            print(f"5. Received response: {data}")
+        print(f"Found controller at {ip} with DIP={msg['dip']}")
+        return (ip, msg["dip"], msg.get("window"), sock, buffered)
 
-            msg = json.loads(data.decode())
+    async def _exchange_enum(self, sock, ip):
+        """Send enum on sock and return the reply and any data after it."""
+        await self.loop.sock_connect(sock, (ip, self.port))
+        await self.loop.sock_sendall(sock, ENUM_COMMAND)
+        buffer = b""
+        while True:
+            while b"\n" not in buffer:
+                data = await self.loop.sock_recv(sock, 1024)
+                if not data:
+                    raise ConnectionResetError("Connection closed")
+                buffer += data
+            line, buffer = buffer.split(b"\n", 1)
+            if not line.strip():
+                continue
+            msg = json.loads(line.decode())
+            # Skip credits or button events that were already on their way
             if msg.get("type") == "controller" and "dip" in msg:
-                print(f"6. Successfully enumerated controller with DIP={msg['dip']}")
-                return (ip, msg["dip"])
-            else:
-                print(f"6. Invalid response format: {msg}")
-                return None
-        except socket.timeout:
-            print(f"Timeout while communicating with {ip}")
-            return None
-        except ConnectionRefusedError:
-            print(f"Connection refused by {ip}")
-            return None
-        except ConnectionResetError:
-            print(f"Connection reset by {ip}")
-            return None
-        except Exception as e:
-            print(f"Error communicating with {ip}: {type(e).__name__}: {e}")
-            return None
-        finally:
-            sock.close()
+                return msg, buffer
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stdint.h>
+
+// CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF), matching
+// binascii.crc_hqx(data, 0xFFFF) on the host.
+constexpr uint16_t kCrc16Init = 0xFFFF;
+
+inline uint16_t Crc16Update(uint16_t crc, uint8_t byte) {
+  crc ^= static_cast<uint16_t>(byte) << 8;
+  for (int i = 0; i < 8; ++i) {
+    crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
@@ -0,0 +1,159 @@
+#include "effect_engine.h"
+
+#include <Arduino.h>
+#include <string.h>
+
+#include <algorithm>
+
+void EffectEngine::start(Effect effect) {
+  effect_ = effect;
+  start_ms_ = millis();
+  last_render_ms_ = start_ms_;
+  rendered_ = false;
+}
+
+void EffectEngine::solid(CRGB color) {
+  color_ = color;
+  start(kSolid);
+}
+
+void EffectEngine::gradient(CRGB first, CRGB last) {
+  color_ = first;
+  color2_ = last;
+  start(kGradient);
+}
+
+void EffectEngine::hue(uint32_t period_ms, uint16_t spread, uint8_t value) {
+  period_ms_ = std::max<uint32_t>(period_ms, 1);
+  amount_ = spread;
+  level_ = value;
+  start(kHue);
+}
+
+void EffectEngine::chase(CRGB color, uint32_t period_ms, uint16_t length) {
+  color_ = color;
+  period_ms_ = std::max<uint32_t>(period_ms, 1);
+  amount_ = length;
+  start(kChase);
+}
+
+void EffectEngine::sparkle(CRGB color, uint8_t chance) {
+  color_ = color;
+  level_ = chance;
+  start(kSparkle);
+}
+
+void EffectEngine::fade_to(CRGB color, uint32_t duration_ms) {
+  capture();
+  fill_solid(target_, num_leds_, color);
+  period_ms_ = duration_ms;
+  easing_ = kLinear;
+  start(kTransition);
+}
+
+void EffectEngine::capture() {
+  captured_effect_ = effect_;
+  captured_ms_ = millis();
+  captured_start_ms_ = start_ms_;
+  captured_period_ms_ = period_ms_;
+  memcpy(from_, leds_, num_leds_ * sizeof(CRGB));
+  if (effect_ == kTransition) {
+    // Keyframes are drawn over the last one, not over a blend towards it
+    memcpy(leds_, target_, num_leds_ * sizeof(CRGB));
+  }
+  effect_ = kOff;
+}
+
+void EffectEngine::restore() {
+  memcpy(leds_, from_, num_leds_ * sizeof(CRGB));
+  effect_ = captured_effect_;
+  start_ms_ = captured_start_ms_;
+  period_ms_ = captured_period_ms_;
+  if (effect_ == kTransition) {
+    // from_ now holds the blend as it was at capture(), and target_ is
+    // untouched, so blend from there over what was left of the transition
+    uint32_t elapsed_ms = captured_ms_ - captured_start_ms_;
+    start_ms_ = captured_ms_;
+    period_ms_ = elapsed_ms < captured_period_ms_
+                     ? captured_period_ms_ - elapsed_ms
+                     : 0;
+  }
+}
+
+void EffectEngine::transition(uint32_t duration_ms, Easing easing) {
+  memcpy(target_, leds_, num_leds_ * sizeof(CRGB));
+  memcpy(leds_, from_, num_leds_ * sizeof(CRGB));
+  period_ms_ = duration_ms;
+  easing_ = easing;
+  start(kTransition);
+}
+
+void EffectEngine::render(uint32_t now_ms) {
+  if (effect_ == kOff) return;
+  if (rendered_ && now_ms - last_render_ms_ < FRAME_INTERVAL_MS) return;
+  last_render_ms_ = now_ms;
+  rendered_ = true;
+
+  bool more = draw(now_ms - start_ms_);
+  frames_.publish(leds_);
+  if (!more) effect_ = kOff;
+}
+
+bool EffectEngine::draw(uint32_t elapsed_ms) {
+  switch (effect_) {
+    case kSolid:
+      fill_solid(leds_, num_leds_, color_);
+      return false;
+
+    case kGradient:
+      fill_gradient_RGB(leds_, num_leds_, color_, color2_);
+      return false;
+
+    case kHue: {
+      uint8_t base = uint64_t{elapsed_ms % period_ms_} * 256 / period_ms_;
+      for (size_t i = 0; i < num_leds_; ++i) {
+        uint8_t offset = i * amount_ / num_leds_;
+        leds_[i] = CHSV(base + offset, 255, level_);
+      }
+      return true;
+    }
+
+    case kChase: {
+      // 64 bits, as the product overflows for long periods on long strips
+      size_t head = uint64_t{elapsed_ms % period_ms_} * num_leds_ / period_ms_;
+      for (size_t i = 0; i < num_leds_; ++i) {
+        // Distance behind the head, wrapping around the end of the strip
+        size_t behind = (head + num_leds_ - i) % num_leds_;
+        leds_[i] = behind < amount_ ? color_ : CRGB::Black;
+      }
+      return true;
+    }
+
+    case kSparkle:
+      fadeToBlackBy(leds_, num_leds_, 32);
+      for (size_t i = 0; i < num_leds_; ++i) {
+        if (random8() < level_) leds_[i] = color_;
+      }
+      return true;
+
+    case kTransition: {
+      if (elapsed_ms >= period_ms_) {
+        memcpy(leds_, target_, num_leds_ * sizeof(CRGB));
+        return false;
+      }
+      fract8 amount = uint64_t{elapsed_ms} * 256 / period_ms_;
+      if (easing_ == kEaseInOutQuad) {
+        amount = ease8InOutQuad(amount);
+      } else if (easing_ == kEaseInOutCubic) {
+        amount = ease8InOutCubic(amount);
+      }
+      for (size_t i = 0; i < num_leds_; ++i) {
+        leds_[i] = blend(from_[i], target_[i], amount);
+      }
+      return true;
+    }
+
+    default:
+      return false;
+  }
+}
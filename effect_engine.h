@@ -0,0 +1,115 @@
+#pragma once
+
+#include <FastLED.h>
+#include <stdint.h>
+
+#include "frame_slot.h"
+
+// Renders LED effects on the controller, so the host only sends an effect's
+// parameters instead of every frame. render() draws the running effect into
+// the LED buffer and publishes it at most once per FRAME_INTERVAL_MS; all
+// arithmetic is 8-bit fixed point (FastLED's scale8, blend and hsv2rgb).
+//
+// While an effect runs it owns the LED buffer; LedCommand stops it when an LED
+// frame starts arriving (see LedCommand::set_engine). Solid and gradient are
+// drawn once and then leave the buffer alone, as do fades and transitions once
+// they complete.
+class EffectEngine {
+ public:
+  static constexpr uint32_t FRAME_INTERVAL_MS = 10;
+
+  enum Easing : uint8_t {
+    kLinear = 0,
+    kEaseInOutQuad = 1,
+    kEaseInOutCubic = 2,
+  };
+
+  // from and target each hold num_leds LEDs, the frames a fade or transition
+  // blends between
+  EffectEngine(CRGB* leds, CRGB* from, CRGB* target, size_t num_leds,
+               FrameSlot& frames)
+      : leds_(leds),
+        from_(from),
+        target_(target),
+        num_leds_(num_leds),
+        frames_(frames) {}
+
+  // Stop the running effect, leaving the LEDs as they are
+  void stop() { effect_ = kOff; }
+  bool running() const { return effect_ != kOff; }
+
+  void solid(CRGB color);
+
+  // Blend from first to last along the strip
+  void gradient(CRGB first, CRGB last);
+
+  // Cycle through all hues every period_ms, with hues spread by up to spread
+  // (256 is the whole colour wheel) along the strip
+  void hue(uint32_t period_ms, uint16_t spread, uint8_t value);
+
+  // A segment of length LEDs travelling along the strip every period_ms
+  void chase(CRGB color, uint32_t period_ms, uint16_t length);
+
+  // Each LED lights up with probability chance/256 per frame and fades out
+  void sparkle(CRGB color, uint8_t chance);
+
+  // Fade from the current LEDs to color over duration_ms
+  void fade_to(CRGB color, uint32_t duration_ms);
+
+  // Keyframe transitions: call capture() before drawing the next keyframe into
+  // the LED buffer, then transition() to blend to it from the LEDs as they were
+  // at capture(). A transition interrupted by capture() continues from where
+  // it got to, while the new keyframe is drawn over the previous one.
+  void capture();
+  void transition(uint32_t duration_ms, Easing easing);
+
+  // Put the LEDs back as they were at capture(), dropping the keyframe, and
+  // resume the effect capture() stopped. An interrupted transition blends on
+  // from where it was at capture() and ends when it would have.
+  void restore();
+
+  // Draw and publish the next frame if one is due. Call from loop().
+  void render(uint32_t now_ms);
+
+ private:
+  enum Effect : uint8_t {
+    kOff,
+    kSolid,
+    kGradient,
+    kHue,
+    kChase,
+    kSparkle,
+    kTransition,
+  };
+
+  CRGB* leds_;
+  CRGB* from_;
+  CRGB* target_;
+  size_t num_leds_;
+  FrameSlot& frames_;
+
+  Effect effect_ = kOff;
+  uint32_t start_ms_ = 0;
+  uint32_t last_render_ms_ = 0;
+  bool rendered_ = false;  // Whether the effect has drawn a frame yet
+
+  // Parameters of the running effect
+  CRGB color_;
+  CRGB color2_;
+  uint32_t period_ms_ = 0;
+  uint16_t amount_ = 0;  // Hue spread or chase length
+  uint8_t level_ = 0;    // Hue value or sparkle chance
+  Easing easing_ = kLinear;
+
+  // Effect stopped by capture(), for restore()
+  Effect captured_effect_ = kOff;
+  uint32_t captured_ms_ = 0;
+  uint32_t captured_start_ms_ = 0;
+  uint32_t captured_period_ms_ = 0;
+
+  void start(Effect effect);
+
+  // Draw the running effect for elapsed_ms since it started. Returns false
+  // once it has finished.
+  bool draw(uint32_t elapsed_ms);
+};
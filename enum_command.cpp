@@ -4,7 +4,10 @@
 void EnumCommand::process(std::string_view args) {
     if (on_enum) on_enum();
     uint8_t dip = pca_.readDIP();
-    uart_->print("{\"type\":\"controller\",\"dip\":");
-    uart_->print(dip);
-    uart_->println("}");
+    tx_.print("{\"type\":\"controller\",\"dip\":");
+    tx_.print(dip);
+    tx_.print(",\"window\":");
+    tx_.print(rx_window_);
+    tx_.println("}");
+    tx_.commit();
 }
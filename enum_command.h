@@ -1,20 +1,22 @@
 #pragma once
-#include <HardwareSerial.h>
-
-#include <functional>
 #include <string_view>
 
 #include "command.h"
 #include "pca9555.h"
+#include "tx_queue.h"
 
 class EnumCommand : public Command {
  public:
-  EnumCommand(PCA9555& pca, HardwareSerial* uart)
-      : Command("enum"), pca_(pca), uart_(uart) {}
+  // rx_window is the number of bytes the host may have in flight, see the
+  // "credit" messages sent by loop()
+  EnumCommand(PCA9555& pca, TxQueue& tx, uint32_t rx_window)
+      : Command("enum"), pca_(pca), tx_(tx), rx_window_(rx_window) {}
   void process(std::string_view args) override;
-  std::function<void()> on_enum;
+  // Called after each enumeration reply
+  void (*on_enum)() = nullptr;
 
  private:
   PCA9555& pca_;
-  HardwareSerial* uart_;
+  TxQueue& tx_;
+  uint32_t rx_window_;
 };
@@ -6,16 +6,35 @@
 
 #include "base64.h"
 #include "ch9120.h"
+#include "color_command.h"
+#include "color_pipeline.h"
 #include "command.h"
 #include "config_command.h"
 #include "led_command.h"
+#include "present_command.h"
+#include "rate_command.h"
 #include "reconf_command.h"
+#include "sequenced_led_command.h"
+#include "stats_command.h"
+#include "transition_command.h"
+#include "tx_queue.h"
 #include "lcd_command.h"
+#include "lcd_framebuffer.h"
 #include <Wire.h>
 #include <LiquidCrystal_PCF8574.h>
 #include "pca9555.h"
+#include "ack_command.h"
 #include "backlight_command.h"
+#include "button_scanner.h"
+#include "effect_engine.h"
 #include "enum_command.h"
+#include "firmware_stats.h"
+#include "frame_slot.h"
+#include "fx_command.h"
+#include "geom_command.h"
+#include "geometry.h"
+#include "led_lanes.h"
+#include "loop_timer.h"
 
 const uint8_t INT_PIN = 2; // GP2 on RP2040
 
@@ -27,7 +46,10 @@ const CH9121Config default_config = {
     .local_port = 51333,
     .target_port = 51334,
     .baud_rate = 921600,
-    .mode = 0x00, // TCP Server mode (was 0x02 for UDP)
+    // TCP Server mode. 0x02 (UDP Server) suits streaming LED frames, which the
+    // host then sends as kFrameLedSeq datagrams, but control messages and
+    // button events are not retransmitted if lost.
+    .mode = 0x00,
 };
 
 CH9121Config config = default_config;
@@ -36,31 +58,98 @@ CH9121Config config = default_config;
 CH9121 ch9121(&Serial2, config, 19, 18);
 
 #define NUM_PIXELS 1
-#define DATA_PIN 25
 
+// LED data pins, one parallel lane each, sharing NUM_PIXELS evenly
+using Lanes = LedLanes<25>;
+static_assert(NUM_PIXELS % Lanes::COUNT == 0,
+              "NUM_PIXELS must split evenly between the lanes");
+
+// Output buffer driven by FastLED on core 1
 CRGB leds[NUM_PIXELS];
 
+// Frame decoded by core 0, and the buffers handing it over to core 1
+CRGB frame[NUM_PIXELS];
+// Last good frame, restored if a frame arrives corrupt or incomplete
+CRGB frame_backup[NUM_PIXELS];
+CRGB frame_buffers[3 * NUM_PIXELS];
+FrameSlot frame_slot(frame_buffers, NUM_PIXELS);
+
+// Colour correction and remapping to wiring order, applied by core 1 as
+// frames are copied to the strip
+ColorPipeline color_pipeline;
+uint16_t geometry_maps[3 * NUM_PIXELS];
+Geometry geometry(geometry_maps, NUM_PIXELS);
+
+// Tagged frame waiting for its present command
+CRGB staged_frame[NUM_PIXELS];
+
+// Frames an effect fades or a keyframe transition blends between
+CRGB blend_from[NUM_PIXELS];
+CRGB blend_target[NUM_PIXELS];
+
 // LCD dimensions
 const uint8_t LCD_WIDTH = 20;
 const uint8_t LCD_HEIGHT = 4;
 
+// Time limit for sending LCD changes in one loop() pass
+const uint32_t LCD_BUDGET_US = 1000;
+
 // Initialize LCD display
 LiquidCrystal_PCF8574 lcd(0x27);
+LcdFramebuffer lcd_fb(lcd, LCD_WIDTH, LCD_HEIGHT);
+
+// Replies and events to the host, sent as Serial2 has room
+TxQueue tx_queue(&Serial2);
+
+// Largest button event message, so events wait in ButtonScanner (which drops
+// the stalest state when full) rather than being cut off by a full TX queue
+const size_t BUTTON_MESSAGE_SIZE = 48;
 
 PCA9555 pca;
+ButtonScanner button_scanner(pca, INT_PIN);
 BacklightCommand backlight_command(pca);
-EnumCommand enum_command(pca, &Serial2);
+// Flow control: the host may have up to RX_WINDOW bytes in flight, and loop()
+// returns {"credit":<bytes>} as it consumes them, once CREDIT_THRESHOLD bytes
+// have been consumed or the RX FIFO has run empty. The window is half the RX
+// FIFO so data already in transit when a credit is sent still fits.
+const uint32_t RX_FIFO_SIZE = 65536;
+const uint32_t RX_WINDOW = RX_FIFO_SIZE / 2;
+const uint32_t CREDIT_THRESHOLD = 1024;
+uint32_t pending_credit = 0;
 
-// Create commands
-LedCommand led_command(leds, NUM_PIXELS);
-ConfigCommand config_command(NUM_PIXELS);
-ReconfCommand reconf_command(ch9121);
-LcdCommand lcd_command(lcd, LCD_WIDTH, LCD_HEIGHT);
-Command* commands[] = {&led_command, &config_command, &reconf_command, &lcd_command, &backlight_command, &enum_command};
-CommandProcessor command_processor(commands);
+EnumCommand enum_command(pca, tx_queue, RX_WINDOW);
 
-volatile bool button_int_flag = false;
-uint8_t last_button_state = 0;
+// Create commands
+LedCommand led_command(frame, NUM_PIXELS, frame_slot);
+ConfigCommand config_command(geometry, Lanes::COUNT, tx_queue);
+GeomCommand geom_command(geometry);
+AckCommand ack_command(led_command, tx_queue);
+RateCommand rate_command(frame_slot);
+FirmwareStats firmware_stats;
+SequencedLedCommand sequenced_led_command(led_command, firmware_stats);
+PresentCommand present_command(led_command, staged_frame, frame_slot);
+EffectEngine effect_engine(frame, blend_from, blend_target, NUM_PIXELS,
+                           frame_slot);
+FxCommand fx_command(effect_engine);
+TransitionCommand transition_command(led_command, effect_engine);
+ColorCommand color_command(color_pipeline);
+StatsCommand stats_command(firmware_stats, frame_slot, pca, lcd_fb, tx_queue);
+ReconfCommand reconf_command(ch9121, tx_queue);
+LcdCommand lcd_command(lcd_fb);
+Command* commands[] = {&led_command, &config_command, &reconf_command, &lcd_command, &backlight_command, &enum_command, &rate_command, &stats_command, &ack_command, &sequenced_led_command, &present_command, &fx_command, &transition_command, &color_command, &geom_command};
+CommandProcessor command_processor(commands, Serial);
+
+// Time limit for draining Serial2 in one loop() pass, so that input polling
+// keeps running while LED frames stream in
+const uint32_t RX_BUDGET_US = 2000;
+const uint32_t LOOP_REPORT_INTERVAL_MS = 1000;
+// Longest wait for the USB serial port at boot
+const uint32_t SERIAL_WAIT_MS = 500;
+
+LoopTimer loop_timer;
+uint32_t last_loop_report = 0;
+uint32_t rx_bytes = 0;
+int rx_fifo_peak = 0;
 
 // Debug/boot message state
 uint8_t boot_dip = 0;
@@ -68,47 +157,48 @@ uint16_t enum_count = 0;
 bool debug_message_enabled = true;
 
 void onButtonInt() {
-  button_int_flag = true;
+  button_scanner.notify();
 }
 
 void show_boot_message() {
   if (!debug_message_enabled) {
     return;
   }
-  uint8_t buttons = pca.readButtons();
-  lcd.setCursor(0, 0);
-  lcd.print("Controller ");
-  lcd.print(boot_dip);
-  lcd.setCursor(0, 1);
-  lcd.print("Enum ");
-  lcd.print(enum_count);
-  lcd.setCursor(0, 2);
-  lcd.print("I/O dbg: [");
+  uint8_t buttons = button_scanner.state();
+  lcd_fb.setCursor(0, 0);
+  lcd_fb.print("Controller ");
+  lcd_fb.print(boot_dip);
+  lcd_fb.setCursor(0, 1);
+  lcd_fb.print("Enum ");
+  lcd_fb.print(enum_count);
+  lcd_fb.setCursor(0, 2);
+  lcd_fb.print("I/O dbg: [");
   for (uint8_t i = 0; i < PCA9555::NUM_BUTTONS; ++i) {
-    lcd.print((buttons >> i) & 1);
+    lcd_fb.print((buttons >> i) & 1);
   }
-  lcd.print("]");
-  lcd.setCursor(0, 3);
-  lcd.print("IP: ");
-  lcd.print(config.local_ip[0]);
-  lcd.print(".");
-  lcd.print(config.local_ip[1]);
-  lcd.print(".");
-  lcd.print(config.local_ip[2]);
-  lcd.print(".");
-  lcd.print(config.local_ip[3]);
+  lcd_fb.print("]");
+  lcd_fb.setCursor(0, 3);
+  lcd_fb.print("IP: ");
+  lcd_fb.print(config.local_ip[0]);
+  lcd_fb.print(".");
+  lcd_fb.print(config.local_ip[1]);
+  lcd_fb.print(".");
+  lcd_fb.print(config.local_ip[2]);
+  lcd_fb.print(".");
+  lcd_fb.print(config.local_ip[3]);
 }
 
 void setup() {
   Serial.begin(921600);
 
-  // Give some time for the serial port to be ready
-  delay(1000);
+  // Give a connected USB host a moment to open the port, without holding up
+  // a headless boot for long
+  uint32_t serial_start = millis();
+  while (!Serial && millis() - serial_start < SERIAL_WAIT_MS) {
+  }
 
   Serial.println("Initializing...");
 
-  FastLED.addLeds<NEOPIXEL, DATA_PIN>(leds, NUM_PIXELS);
-
   // Initialize I2C and LCD
   Wire.setSDA(0);
   Wire.setSCL(1);
@@ -127,7 +217,7 @@ void setup() {
   // put your setup code here, to run once:
   Serial2.setTX(20);
   Serial2.setRX(21);
-  Serial2.setFIFOSize(65536);
+  Serial2.setFIFOSize(RX_FIFO_SIZE);
 
   // PCA9555 setup
   pca.begin();
@@ -143,20 +233,20 @@ void setup() {
   Serial.println(config.local_ip[3]);
 
   Serial.println("Starting CH9121 config...");
+  uint32_t config_start = millis();
   ch9121.Begin();
-  delay(1000); // Give more time for hardware initialization
-  ch9121.Configure();
-  delay(1000); // Give more time for configuration to take effect
-  Serial.println("Finished CH9121 config");
+  int written = ch9121.Configure();
+  Serial.printf("Finished CH9121 config: %d fields written in %lu ms\n",
+                written, millis() - config_start);
 
   // Clear LCD and show ready message
   lcd.clear();
-  lcd.print("Ready");
+  lcd_fb.reset();
+  lcd_fb.print("Ready");
 
   // INT pin setup
-  pinMode(INT_PIN, INPUT_PULLUP);
+  button_scanner.begin();
   attachInterrupt(digitalPinToInterrupt(INT_PIN), onButtonInt, FALLING);
-  last_button_state = pca.readButtons();
 
   enum_count = 0;
   debug_message_enabled = true;
@@ -168,26 +258,129 @@ void setup() {
     Serial.print("Enumeration request received. Count: ");
     Serial.println(enum_count);
   };
+  stats_command.set_processor(&command_processor);
+  led_command.set_backup(frame_backup);
+  led_command.set_engine(&effect_engine);
   lcd_command.on_clear = []() {
     debug_message_enabled = false;
   };
 }
 
+// Feed everything waiting in the Serial2 FIFO to the command processor, up to
+// RX_BUDGET_US per call
+void drain_uart() {
+  uint32_t start = micros();
+  char rx_buf[256];
+  do {
+    int available = Serial2.available();
+    if (available <= 0) break;
+    rx_fifo_peak = std::max(rx_fifo_peak, available);
+    firmware_stats.rx_fifo_high_water =
+        std::max(firmware_stats.rx_fifo_high_water, available);
+    size_t count = Serial2.readBytes(
+        rx_buf, std::min<size_t>(available, sizeof(rx_buf)));
+    rx_bytes += count;
+    pending_credit += count;
+    firmware_stats.rx_bytes += count;
+    command_processor.process_chars(std::string_view(rx_buf, count));
+  } while (micros() - start < RX_BUDGET_US);
+}
+
+// Return consumed receive bytes to the host as flow control credit
+void send_credit() {
+  if (pending_credit == 0) return;
+  if (pending_credit < CREDIT_THRESHOLD && Serial2.available() > 0) return;
+  tx_queue.print("{\"credit\":");
+  tx_queue.print(pending_credit);
+  tx_queue.println("}");
+  // If the queue is full the credit stays pending for the next attempt
+  if (tx_queue.commit()) pending_credit = 0;
+}
+
+// Print loop timing and receive statistics to USB serial once per interval
+void report_loop_stats() {
+  uint32_t now = millis();
+  if (now - last_loop_report < LOOP_REPORT_INTERVAL_MS) return;
+  last_loop_report = now;
+  if (Serial) {
+    Serial.printf("loop: %lu iters, avg %lu us, max %lu us, rx %lu B, "
+                  "fifo peak %d\n",
+                  loop_timer.iterations(), loop_timer.average_us(),
+                  loop_timer.max_us(), rx_bytes, rx_fifo_peak);
+    Serial.printf("frames: %lu published, %lu presented, %lu dropped\n",
+                  frame_slot.published(), frame_slot.presented(),
+                  frame_slot.dropped());
+  }
+  loop_timer.reset();
+  rx_bytes = 0;
+  rx_fifo_peak = 0;
+}
+
 void loop() {
-  // put your main code here, to run repeatedly:
-  if (Serial2.available()) {
-    char value = Serial2.read();
-    command_processor.process_char(value);
+  uint32_t loop_start = micros();
+
+  // While the CH9121 is being reconfigured Serial2 carries its configuration
+  // commands, so it is neither drained nor written and replies and events wait
+  // in tx_queue
+  bool reconfiguring = reconf_command.step();
+  if (!reconfiguring) {
+    drain_uart();
+    send_credit();
   }
-  uint8_t state = pca.readButtons();
-  if (state != last_button_state) {
-    Serial2.print("{\"buttons\":[");
+
+  present_command.poll(millis());
+  effect_engine.render(millis());
+
+  button_scanner.poll(millis());
+  ButtonEvent event;
+  bool buttons_changed = false;
+  while (tx_queue.space() >= BUTTON_MESSAGE_SIZE &&
+         button_scanner.pop(event)) {
+    tx_queue.print("{\"buttons\":[");
     for (uint8_t i = 0; i < PCA9555::NUM_BUTTONS; ++i) {
-      Serial2.print((state >> i) & 1);
-      if (i < PCA9555::NUM_BUTTONS - 1) Serial2.print(",");
+      tx_queue.print((event.state >> i) & 1);
+      if (i < PCA9555::NUM_BUTTONS - 1) tx_queue.print(",");
     }
-    Serial2.println("]}");
-    last_button_state = state;
+    tx_queue.print("],\"t\":");
+    tx_queue.print(event.time_ms);
+    tx_queue.println("}");
+    tx_queue.commit();
+    buttons_changed = true;
+  }
+  if (buttons_changed) {
     show_boot_message();
   }
+
+  lcd_fb.flush(LCD_BUDGET_US);
+  if (!reconfiguring) tx_queue.service();
+
+  uint32_t loop_us = micros() - loop_start;
+  loop_timer.record(loop_us);
+  firmware_stats.loop_us.record(loop_us);
+  report_loop_stats();
+}
+
+// Core 1 owns LED output, so the time FastLED.show() spends clocking out the
+// strip overlaps with UART parsing on core 0.
+void setup1() {
+  Lanes::add(leds, NUM_PIXELS);
+}
+
+// Versions of the colour and geometry tables the LEDs were last shown with
+uint32_t shown_color_version = 0;
+uint32_t shown_geometry_version = 0;
+
+void loop1() {
+  // A colour or geometry change re-shows the current frame through the new
+  // tables
+  if (frame_slot.take(micros()) ||
+      color_pipeline.version() != shown_color_version ||
+      geometry.version() != shown_geometry_version) {
+    const uint16_t* map = geometry.acquire(shown_geometry_version);
+    shown_color_version =
+        color_pipeline.apply(leds, frame_slot.front(), map, NUM_PIXELS);
+    uint32_t start = micros();
+    FastLED.show();
+    firmware_stats.show_us.record(micros() - start);
+  }
 }
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "latency_histogram.h"
+
+// Counters kept by the main loops, reported by StatsCommand
+struct FirmwareStats {
+  uint32_t rx_bytes = 0;        // Bytes read from the network UART
+  int rx_fifo_high_water = 0;   // Most bytes seen waiting in the RX FIFO
+  uint32_t stale_frames = 0;    // Sequenced LED frames dropped as out of order
+  LatencyHistogram loop_us;     // loop() iteration time on core 0
+  LatencyHistogram show_us;     // FastLED.show() time, written by core 1
+};
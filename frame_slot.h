@@ -0,0 +1,92 @@
+#pragma once
+
+#include <FastLED.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <atomic>
+
+// Hands completed LED frames from one core to the other. Three buffers rotate
+// between the producer (being written), the consumer (being shown) and a
+// shared middle slot holding the newest completed frame, which are swapped
+// with a single atomic exchange. A frame published before the consumer took
+// the previous one replaces it and is counted as dropped, so under overload
+// only the newest frame is shown. The consumer can be limited to a maximum
+// refresh rate.
+class FrameSlot {
+ public:
+  // storage must hold 3 * num_leds LEDs
+  FrameSlot(CRGB* storage, size_t num_leds)
+      : storage_(storage), num_leds_(num_leds) {
+    memset(storage_, 0, 3 * num_leds_ * sizeof(CRGB));
+  }
+
+  size_t num_leds() const { return num_leds_; }
+
+  // Limit take() to max_hz frames per second, 0 for no limit
+  void set_max_rate(uint16_t max_hz) {
+    min_interval_us_.store(max_hz ? 1000000 / max_hz : 0,
+                           std::memory_order_relaxed);
+  }
+
+  // Producer: copy frame into the back buffer and publish it
+  void publish(const CRGB* frame) {
+    memcpy(buffer(back_), frame, num_leds_ * sizeof(CRGB));
+    uint8_t old = middle_.exchange(back_ | FRESH, std::memory_order_acq_rel);
+    back_ = old & ~FRESH;
+    increment(published_);
+    if (old & FRESH) increment(dropped_);
+  }
+
+  // Consumer: if a frame was published since the last call and the refresh
+  // interval has passed, make it the front buffer and return true
+  bool take(uint32_t now_us) {
+    if (now_us - last_take_us_ <
+        min_interval_us_.load(std::memory_order_relaxed)) {
+      return false;
+    }
+    if (!(middle_.load(std::memory_order_acquire) & FRESH)) return false;
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & ~FRESH;
+    last_take_us_ = now_us;
+    increment(presented_);
+    return true;
+  }
+
+  // Consumer: the frame returned by the last successful take()
+  const CRGB* front() const { return buffer(front_); }
+
+  // Frame counters, safe to read from either core
+  uint32_t published() const {
+    return published_.load(std::memory_order_relaxed);
+  }
+  uint32_t presented() const {
+    return presented_.load(std::memory_order_relaxed);
+  }
+  uint32_t dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static constexpr uint8_t FRESH = 0x80;
+
+  CRGB* storage_;
+  size_t num_leds_;
+  uint8_t back_ = 0;   // Owned by the producer
+  uint8_t front_ = 1;  // Owned by the consumer
+  std::atomic<uint8_t> middle_{2};
+
+  uint32_t last_take_us_ = 0;  // Owned by the consumer
+  std::atomic<uint32_t> min_interval_us_{0};
+
+  // Each counter is only written by one core
+  std::atomic<uint32_t> published_{0};
+  std::atomic<uint32_t> presented_{0};
+  std::atomic<uint32_t> dropped_{0};
+
+  static void increment(std::atomic<uint32_t>& counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1,
+                  std::memory_order_relaxed);
+  }
+
+  CRGB* buffer(uint8_t index) const { return storage_ + index * num_leds_; }
+};
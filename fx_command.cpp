@@ -0,0 +1,71 @@
+#include "fx_command.h"
+
+#include <Arduino.h>
+
+#include <algorithm>
+#include <charconv>
+#include <system_error>
+
+int FxCommand::parse_params(std::string_view args, uint32_t* params) {
+  int count = 0;
+  while (!args.empty()) {
+    if (count == static_cast<int>(MAX_PARAMS)) return -1;
+    std::string_view token = args.substr(0, args.find(':'));
+    auto result = std::from_chars(token.data(), token.data() + token.size(),
+                                  params[count]);
+    if (result.ec != std::errc() || result.ptr != token.data() + token.size()) {
+      return -1;
+    }
+    ++count;
+    args.remove_prefix(std::min(token.size() + 1, args.size()));
+  }
+  return count;
+}
+
+bool FxCommand::to_color(const uint32_t* params, CRGB& color) {
+  if (params[0] > 255 || params[1] > 255 || params[2] > 255) return false;
+  color = CRGB(params[0], params[1], params[2]);
+  return true;
+}
+
+void FxCommand::process(std::string_view args) {
+  std::string_view name = args.substr(0, args.find(':'));
+  args.remove_prefix(std::min(name.size() + 1, args.size()));
+
+  uint32_t params[MAX_PARAMS];
+  int count = parse_params(args, params);
+  CRGB color;
+  CRGB color2;
+  bool ok = false;
+
+  if (name == "off") {
+    ok = count == 0;
+    if (ok) engine_.stop();
+  } else if (name == "solid") {
+    ok = count == 3 && to_color(params, color);
+    if (ok) engine_.solid(color);
+  } else if (name == "gradient") {
+    ok = count == 6 && to_color(params, color) && to_color(params + 3, color2);
+    if (ok) engine_.gradient(color, color2);
+  } else if (name == "hue") {
+    ok = count >= 1 && count <= 3 && (count < 2 || params[1] <= 0xFFFF) &&
+         (count < 3 || params[2] <= 255);
+    if (ok) {
+      engine_.hue(params[0], count >= 2 ? params[1] : 0,
+                  count >= 3 ? params[2] : 255);
+    }
+  } else if (name == "chase") {
+    ok = count == 5 && to_color(params, color) && params[4] <= 0xFFFF;
+    if (ok) engine_.chase(color, params[3], params[4]);
+  } else if (name == "sparkle") {
+    ok = count == 4 && to_color(params, color) && params[3] <= 255;
+    if (ok) engine_.sparkle(color, params[3]);
+  } else if (name == "fade") {
+    ok = count == 4 && to_color(params, color);
+    if (ok) engine_.fade_to(color, params[3]);
+  }
+
+  if (!ok) {
+    Serial.println("Invalid fx command format");
+  }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <FastLED.h>
+#include <stdint.h>
+
+#include <string_view>
+
+#include "command.h"
+#include "effect_engine.h"
+
+// "fx:<effect>[:<param>...]" starts an effect on the EffectEngine. Colours are
+// three decimal r:g:b fields.
+//   fx:off                                  stop, keeping the current LEDs
+//   fx:solid:<rgb>
+//   fx:gradient:<rgb>:<rgb>                 first to last LED
+//   fx:hue:<period_ms>[:<spread>[:<value>]]  spread 256 is a full rainbow
+//   fx:chase:<rgb>:<period_ms>:<length>
+//   fx:sparkle:<rgb>:<chance>               chance per LED per frame, of 256
+//   fx:fade:<rgb>:<duration_ms>
+class FxCommand : public Command {
+ public:
+  FxCommand(EffectEngine& engine) : Command("fx"), engine_(engine) {}
+
+  void process(std::string_view args) override;
+
+ private:
+  static constexpr size_t MAX_PARAMS = 6;
+
+  EffectEngine& engine_;
+
+  // Parse colon separated decimal numbers into params. Returns the number
+  // parsed, or -1 if there are too many or one is not a number.
+  int parse_params(std::string_view args, uint32_t* params);
+
+  // Colour from three parameters, or false if one is out of range
+  bool to_color(const uint32_t* params, CRGB& color);
+};
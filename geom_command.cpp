@@ -0,0 +1,37 @@
+#include "geom_command.h"
+
+#include <Arduino.h>
+
+#include <algorithm>
+#include <charconv>
+#include <system_error>
+
+void GeomCommand::process(std::string_view args) {
+  if (args == "linear") {
+    geometry_.set_linear();
+    return;
+  }
+
+  constexpr std::string_view kCube = "cube:";
+  if (args.substr(0, kCube.size()) != kCube) {
+    Serial.println("Invalid geom command format");
+    return;
+  }
+  args.remove_prefix(kCube.size());
+
+  std::string_view size_str = args.substr(0, args.find(':'));
+  std::string_view wiring = args.substr(
+      std::min(size_str.size() + 1, args.size()));
+  uint16_t size;
+  auto result = std::from_chars(size_str.data(),
+                                size_str.data() + size_str.size(), size);
+  if (result.ec != std::errc() ||
+      result.ptr != size_str.data() + size_str.size() ||
+      !(wiring.empty() || wiring == "serpentine")) {
+    Serial.println("Invalid geom command format");
+    return;
+  }
+  if (!geometry_.set_cube(size, !wiring.empty())) {
+    Serial.println("Cube does not fit the LED strip");
+  }
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string_view>
+
+#include "command.h"
+#include "geometry.h"
+
+// "geom:linear" or "geom:cube:<n>[:serpentine]" sets the LED layout, see
+// Geometry
+class GeomCommand : public Command {
+ public:
+  GeomCommand(Geometry& geometry) : Command("geom"), geometry_(geometry) {}
+
+  void process(std::string_view args) override;
+
+ private:
+  Geometry& geometry_;
+};
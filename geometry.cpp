@@ -0,0 +1,50 @@
+#include "geometry.h"
+
+Geometry::Geometry(uint16_t* maps, size_t num_leds)
+    : maps_(maps), num_leds_(num_leds) {
+  for (size_t i = 0; i < 3 * num_leds; ++i) {
+    maps[i] = i % num_leds;
+  }
+}
+
+void Geometry::set_linear() {
+  uint8_t next = switch_.writable();
+  uint16_t* map = maps_ + next * num_leds_;
+  for (size_t i = 0; i < num_leds_; ++i) map[i] = i;
+  cube_size_ = 0;
+  serpentine_ = false;
+  switch_.publish(next);
+}
+
+bool Geometry::set_cube(uint16_t size, bool serpentine) {
+  size_t cube_leds = static_cast<size_t>(size) * size * size;
+  if (size == 0 || cube_leds > num_leds_) return false;
+
+  uint8_t next = switch_.writable();
+  uint16_t* map = maps_ + next * num_leds_;
+  for (size_t i = 0; i < num_leds_; ++i) {
+    if (i >= cube_leds) {
+      map[i] = i;
+      continue;
+    }
+    size_t x = i % size;
+    size_t row = i / size;  // y + size * z
+    if (serpentine && (row & 1)) x = size - 1 - x;
+    map[i] = row * size + x;
+  }
+  cube_size_ = size;
+  serpentine_ = serpentine;
+  switch_.publish(next);
+  return true;
+}
+
+void Geometry::print_json(Print& out) const {
+  if (cube_size_ == 0) {
+    out.print("\"geom\": \"linear\"");
+    return;
+  }
+  out.print("\"geom\": \"cube\", \"size\": ");
+  out.print(cube_size_);
+  out.print(", \"serpentine\": ");
+  out.print(serpentine_ ? "true" : "false");
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "table_switch.h"
+
+// Physical layout of the LEDs. Frames are sent in logical order and scattered
+// into wiring order on the way to the strip through a remap table:
+//   linear  logical order is wiring order
+//   cube    LED x + n * (y + n * z) of an n*n*n cube, wired as n*n rows of n
+//           LEDs along x, row y of layer z being row y + n * z on the strip;
+//           serpentine wiring runs every other row backwards
+// LEDs past the end of the cube keep their position.
+//
+// The geometry is set on core 0 and the table read on core 1, handed over by
+// a TableSwitch.
+class Geometry {
+ public:
+  // maps holds 3 * num_leds entries
+  Geometry(uint16_t* maps, size_t num_leds);
+
+  void set_linear();
+
+  // Returns false, leaving the geometry alone, if the cube needs more LEDs
+  // than there are
+  bool set_cube(uint16_t size, bool serpentine);
+
+  // Write the layout as JSON members, e.g. "geom": "cube", "size": 8
+  void print_json(Print& out) const;
+
+  size_t num_leds() const { return num_leds_; }
+
+  // Core 1: the current table, giving the strip position of each logical LED
+  const uint16_t* acquire(uint32_t& version) {
+    return maps_ + switch_.acquire(version) * num_leds_;
+  }
+
+  // Incremented whenever the geometry changes
+  uint32_t version() const { return switch_.version(); }
+
+ private:
+  uint16_t* maps_;
+  size_t num_leds_;
+  TableSwitch switch_;
+
+  // Description of the current geometry, core 0 only
+  uint16_t cube_size_ = 0;  // 0 for linear
+  bool serpentine_ = false;
+};
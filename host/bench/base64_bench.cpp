@@ -0,0 +1,71 @@
+// Base64 decoding throughput of the current decoder against the reference
+// (per-character) decoder, on clean input and on input with line breaks,
+// which keeps the decoder off its group-at-a-time fast path.
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "base64.h"
+#include "base64_reference.h"
+#include "host_support.h"
+
+namespace {
+
+std::string Input(size_t size, bool line_breaks) {
+  std::string data(size, '\0');
+  for (size_t i = 0; i < size; ++i) data[i] = i * 37 + 11;
+  std::string text = Base64Encode(data);
+  if (line_breaks) {
+    for (size_t pos = 76; pos < text.size(); pos += 78) {
+      text.insert(pos, "\r\n");
+    }
+  }
+  return text;
+}
+
+template <bool (*Decode)(std::span<const uint8_t>, std::span<uint8_t>)>
+void BM_Decode(benchmark::State& state) {
+  std::string text = Input(state.range(0), state.range(1));
+  std::span<const uint8_t> in(reinterpret_cast<const uint8_t*>(text.data()),
+                              text.size());
+  std::vector<uint8_t> out(state.range(0));
+  for (auto _ : state) {
+    bool ok = Decode(in, out);
+    benchmark::DoNotOptimize(ok);
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+// The 64-byte pieces LedCommand decodes a streamed line in
+void BM_DecoderChunks(benchmark::State& state) {
+  std::string text = Input(state.range(0), state.range(1));
+  uint8_t out[64];
+  Base64Decoder decoder;
+  for (auto _ : state) {
+    decoder.Reset();
+    for (size_t pos = 0; pos < text.size(); pos += sizeof(out)) {
+      size_t length = std::min(sizeof(out), text.size() - pos);
+      int count = decoder.Decode(
+          {reinterpret_cast<const uint8_t*>(text.data()) + pos, length}, out);
+      benchmark::DoNotOptimize(count);
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+// {decoded bytes, line breaks}
+void Args(benchmark::internal::Benchmark* bench) {
+  bench->ArgNames({"bytes", "breaks"});
+  for (int breaks : {0, 1}) bench->Args({3072, breaks});
+}
+
+BENCHMARK(BM_Decode<ReferenceBase64Decode>)
+    ->Name("BM_ReferenceBase64Decode")
+    ->Apply(Args);
+BENCHMARK(BM_Decode<Base64Decode>)->Name("BM_Base64Decode")->Apply(Args);
+BENCHMARK(BM_DecoderChunks)->Apply(Args);
+
+}  // namespace
@@ -0,0 +1,92 @@
+// Cost of colour correction as core 1 copies a frame to the strip:
+//   BM_MappedCopy         the copy through the LED map alone
+//   BM_ColorPipeline      the copy through ColorPipeline's lookup tables
+//   BM_PerPixelCorrection the same correction computed per channel with
+//                         powf, which the tables replace
+//   BM_Configure          rebuilding the tables after a "color:" command
+// The copies report pixels/s. The RP2040 has no FPU, so powf costs far more
+// there than the host figures suggest.
+
+#include <benchmark/benchmark.h>
+#include <math.h>
+
+#include <vector>
+
+#include "color_pipeline.h"
+#include "host_support.h"
+
+namespace {
+
+const ColorPipeline::Settings kSettings = {
+    .gamma = 2.2f, .brightness = 200, .balance = {255, 224, 192}};
+
+// A serpentine map, like Geometry builds for a cube
+std::vector<uint16_t> Map(size_t count) {
+  std::vector<uint16_t> map(count);
+  const size_t row = 16;
+  for (size_t i = 0; i < count; ++i) {
+    size_t y = i / row, x = i % row;
+    map[i] = y * row + (y % 2 ? row - 1 - x : x);
+  }
+  return map;
+}
+
+void BM_MappedCopy(benchmark::State& state) {
+  size_t count = state.range(0);
+  std::vector<CRGB> in = TestPattern(count), out(count);
+  std::vector<uint16_t> map = Map(count);
+  for (auto _ : state) {
+    for (size_t i = 0; i < count; ++i) out[map[i]] = in[i];
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.counters["pixels/s"] = benchmark::Counter(
+      state.iterations() * count, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_MappedCopy)->Arg(256)->Arg(1024);
+
+void BM_ColorPipeline(benchmark::State& state) {
+  size_t count = state.range(0);
+  std::vector<CRGB> in = TestPattern(count), out(count);
+  std::vector<uint16_t> map = Map(count);
+  ColorPipeline pipeline;
+  pipeline.configure(kSettings);
+  for (auto _ : state) {
+    uint32_t version = pipeline.apply(out.data(), in.data(), map.data(), count);
+    benchmark::DoNotOptimize(version);
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.counters["pixels/s"] = benchmark::Counter(
+      state.iterations() * count, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_ColorPipeline)->Arg(256)->Arg(1024);
+
+void BM_PerPixelCorrection(benchmark::State& state) {
+  size_t count = state.range(0);
+  std::vector<CRGB> in = TestPattern(count), out(count);
+  std::vector<uint16_t> map = Map(count);
+  for (auto _ : state) {
+    for (size_t i = 0; i < count; ++i) {
+      CRGB& led = out[map[i]];
+      for (int c = 0; c < 3; ++c) {
+        float level =
+            powf(in[i].raw[c] / 255.0f, kSettings.gamma) * kSettings.brightness;
+        led.raw[c] = lroundf(level * kSettings.balance[c] / 255.0f);
+      }
+    }
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.counters["pixels/s"] = benchmark::Counter(
+      state.iterations() * count, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_PerPixelCorrection)->Arg(256)->Arg(1024);
+
+void BM_Configure(benchmark::State& state) {
+  ColorPipeline pipeline;
+  for (auto _ : state) {
+    pipeline.configure(kSettings);
+    benchmark::DoNotOptimize(pipeline.version());
+  }
+}
+BENCHMARK(BM_Configure);
+
+}  // namespace
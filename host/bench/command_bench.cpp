@@ -0,0 +1,160 @@
+// Throughput of each command type through CommandProcessor, with the I2C and
+// UART traffic it causes. Run host_benchmarks and compare the counters:
+//   cmds/s       commands processed per second of host CPU time
+//   frames/s     LED frames decoded and published per second
+//   i2c_B/cmd    I2C bytes (both directions) per command
+//   uart_B/cmd   bytes queued for the network UART per command
+
+#include <LiquidCrystal_PCF8574.h>
+#include <Wire.h>
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "backlight_command.h"
+#include "command.h"
+#include "config_command.h"
+#include "enum_command.h"
+#include "fake_pca9555.h"
+#include "frame_slot.h"
+#include "geometry.h"
+#include "host_support.h"
+#include "lcd_command.h"
+#include "lcd_framebuffer.h"
+#include "led_command.h"
+#include "pca9555.h"
+#include "tx_queue.h"
+
+namespace {
+
+constexpr size_t kMaxLeds = 1024;
+
+// The sketch's command set on the host buses
+struct Controller {
+  Controller() {
+    ResetHost();
+    Wire.attach(PCA9555::I2C_ADDR, &chip);
+    pca.begin();
+    lcd.begin(20, 4);
+  }
+
+  // Run lines through the processor, then send what they queued
+  void process(std::string_view lines) {
+    processor.process_chars(lines);
+    lcd_fb.flush(UINT32_MAX);
+    tx.service();
+    Serial2.take_output();
+  }
+
+  FakePca9555 chip;
+  PCA9555 pca;
+  LiquidCrystal_PCF8574 lcd{0x27};
+  LcdFramebuffer lcd_fb{lcd, 20, 4};
+  TxQueue tx{&Serial2};
+
+  CRGB frame[kMaxLeds];
+  CRGB storage[3 * kMaxLeds];
+  FrameSlot slot{storage, kMaxLeds};
+  uint16_t maps[3 * kMaxLeds];
+  Geometry geometry{maps, kMaxLeds};
+
+  LedCommand led{frame, kMaxLeds, slot};
+  ConfigCommand config{geometry, 1, tx};
+  LcdCommand lcd_command{lcd_fb};
+  BacklightCommand backlight{pca};
+  EnumCommand enumerate{pca, tx, 32768};
+  Command* commands[5] = {&led, &config, &lcd_command, &backlight,
+                          &enumerate};
+  CommandProcessor processor{commands, Serial};
+};
+
+// Runs alternating lines and reports per-command counters
+void RunCommands(benchmark::State& state, Controller& controller,
+                 const std::vector<std::string>& lines) {
+  uint64_t i2c_start = Wire.bytes();
+  uint64_t uart_start = Serial2.bytes_written();
+  size_t i = 0;
+  for (auto _ : state) {
+    controller.process(lines[i]);
+    i = (i + 1) % lines.size();
+  }
+  using benchmark::Counter;
+  double commands = state.iterations();
+  state.counters["cmds/s"] = Counter(commands, Counter::kIsRate);
+  state.counters["i2c_B/cmd"] = (Wire.bytes() - i2c_start) / commands;
+  state.counters["uart_B/cmd"] =
+      (Serial2.bytes_written() - uart_start) / commands;
+}
+
+void BM_LedText(benchmark::State& state) {
+  Controller controller;
+  std::vector<std::string> lines;
+  for (uint8_t seed : {0, 1}) {
+    std::string payload = LedPayload(TestPattern(state.range(0), seed));
+    lines.push_back("led:" + Base64Encode(payload) + "\n");
+  }
+  RunCommands(state, controller, lines);
+  state.counters["frames/s"] = benchmark::Counter(
+      controller.slot.published(), benchmark::Counter::kIsRate);
+  state.SetBytesProcessed(state.iterations() * lines[0].size());
+}
+BENCHMARK(BM_LedText)->Arg(64)->Arg(512);
+
+void BM_LedBinary(benchmark::State& state) {
+  Controller controller;
+  std::vector<std::string> frames;
+  for (uint8_t seed : {0, 1}) {
+    frames.push_back(BinaryFrame(
+        kFrameLed, LedPayload(TestPattern(state.range(0), seed))));
+  }
+  RunCommands(state, controller, frames);
+  state.counters["frames/s"] = benchmark::Counter(
+      controller.slot.published(), benchmark::Counter::kIsRate);
+  state.SetBytesProcessed(state.iterations() * frames[0].size());
+}
+BENCHMARK(BM_LedBinary)->Arg(64)->Arg(512);
+
+void BM_LedPatch(benchmark::State& state) {
+  Controller controller;
+  // Fill half the strip, then set a few scattered LEDs
+  std::string patch = {char(0xFF), char(0xFF), LedCommand::OP_FILL, 0, 0,
+                       0,          2,          1,  2, 3};
+  for (uint16_t led = 600; led < 640; led += 8) {
+    patch += {LedCommand::OP_SET, char(led & 0xFF), char(led >> 8), 1, 9, 9,
+              9};
+  }
+  std::vector<std::string> frames = {BinaryFrame(kFrameLed, patch)};
+  RunCommands(state, controller, frames);
+  state.counters["frames/s"] = benchmark::Counter(
+      controller.slot.published(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_LedPatch);
+
+void BM_Lcd(benchmark::State& state) {
+  Controller controller;
+  RunCommands(state, controller,
+              {"lcd:0:1:Temperature 21C\n", "lcd:0:1:Temperature 22C\n"});
+}
+BENCHMARK(BM_Lcd);
+
+void BM_Backlight(benchmark::State& state) {
+  Controller controller;
+  RunCommands(state, controller,
+              {"backlight:1:0:1:0:1:0\n", "backlight:0:1:0:1:0:1\n"});
+}
+BENCHMARK(BM_Backlight);
+
+void BM_Enum(benchmark::State& state) {
+  Controller controller;
+  RunCommands(state, controller, {"enum\n"});
+}
+BENCHMARK(BM_Enum);
+
+void BM_Config(benchmark::State& state) {
+  Controller controller;
+  RunCommands(state, controller, {"?\n"});
+}
+BENCHMARK(BM_Config);
+
+}  // namespace
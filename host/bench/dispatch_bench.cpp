@@ -0,0 +1,97 @@
+// Cost of finding each line's command, with the dispatch tables against the
+// linear scan they replaced (LinearCommandProcessor). The commands are stubs
+// registered with the sketch's prefixes in the sketch's order, so the numbers
+// are the processor's own:
+//   lines/s   lines dispatched per second of host CPU time
+// "mix" is one line for each command but led (which is streamed rather than
+// dispatched per line); "last" repeats a line for the last command registered,
+// the linear scan's worst case.
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "command.h"
+#include "host_support.h"
+#include "linear_command_processor.h"
+
+namespace {
+
+class StubCommand : public Command {
+ public:
+  using Command::Command;
+  void process(std::string_view args) override {
+    benchmark::DoNotOptimize(args.data());
+  }
+};
+
+// As registered in eth_cube_controller.ino
+struct SketchCommands {
+  StubCommand led{"led", /*streaming=*/true, kFrameLed};
+  StubCommand config{"?"};
+  StubCommand reconf{"reconf"};
+  StubCommand lcd{"lcd"};
+  StubCommand backlight{"backlight"};
+  StubCommand enumerate{"enum"};
+  StubCommand rate{"rate"};
+  StubCommand stats{"stats"};
+  StubCommand ack{"ack"};
+  StubCommand ledseq{"ledseq", /*streaming=*/false, kFrameLedSeq};
+  StubCommand present{"present", /*streaming=*/false, kFrameLedTagged};
+  StubCommand fx{"fx"};
+  StubCommand transition{"transition", /*streaming=*/false,
+                         kFrameLedTransition};
+  StubCommand color{"color"};
+  StubCommand geom{"geom"};
+  Command* all[15] = {&led,       &config, &reconf,     &lcd,   &backlight,
+                      &enumerate, &rate,   &stats,      &ack,   &ledseq,
+                      &present,   &fx,     &transition, &color, &geom};
+};
+
+std::string Lines(bool last) {
+  if (last) {
+    std::string lines;
+    for (int i = 0; i < 14; ++i) lines += "geom:cube:8:serpentine\n";
+    return lines;
+  }
+  return "?\n"
+         "reconf:status\n"
+         "lcd:0:1:Hello\n"
+         "backlight:1:0:1:0\n"
+         "enum\n"
+         "rate:60\n"
+         "stats\n"
+         "ack:1\n"
+         "ledseq\n"
+         "present:7\n"
+         "fx:hue:4000:256:255\n"
+         "transition\n"
+         "color:gamma:2.2\n"
+         "geom:cube:8:serpentine\n";
+}
+
+template <typename Processor>
+void Dispatch(benchmark::State& state, bool last) {
+  ResetHost();
+  SketchCommands commands;
+  Processor processor(commands.all, Serial);
+  std::string lines = Lines(last);
+  for (auto _ : state) processor.process_chars(lines);
+  state.counters["lines/s"] =
+      benchmark::Counter(state.iterations() * 14, benchmark::Counter::kIsRate);
+}
+
+void BM_LinearDispatch(benchmark::State& state, bool last) {
+  Dispatch<LinearCommandProcessor>(state, last);
+}
+BENCHMARK_CAPTURE(BM_LinearDispatch, mix, false);
+BENCHMARK_CAPTURE(BM_LinearDispatch, last, true);
+
+void BM_TableDispatch(benchmark::State& state, bool last) {
+  Dispatch<CommandProcessor>(state, last);
+}
+BENCHMARK_CAPTURE(BM_TableDispatch, mix, false);
+BENCHMARK_CAPTURE(BM_TableDispatch, last, true);
+
+}  // namespace
@@ -0,0 +1,76 @@
+// Render cost of each EffectEngine effect, including publishing the frame:
+//   frames/s   frames drawn and published per second of host CPU time
+// Solid and gradient draw once and stop, so they are restarted every frame.
+// Hue's colour conversion is the FastLED shim's, not hsv2rgb_rainbow itself.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "effect_engine.h"
+#include "frame_slot.h"
+#include "host_support.h"
+
+namespace {
+
+enum Effect { kSolid, kGradient, kHue, kChase, kSparkle, kFade, kTransition };
+
+void Start(EffectEngine& engine, Effect effect, std::vector<CRGB>& leds) {
+  switch (effect) {
+    case kSolid:
+      engine.solid(CRGB::Red);
+      break;
+    case kGradient:
+      engine.gradient(CRGB::Red, CRGB::Blue);
+      break;
+    case kHue:
+      engine.hue(4000, 256, 255);
+      break;
+    case kChase:
+      engine.chase(CRGB::Green, 2000, 16);
+      break;
+    case kSparkle:
+      engine.sparkle(CRGB::White, 8);
+      break;
+    case kFade:
+      engine.fade_to(CRGB::Blue, UINT32_MAX);
+      break;
+    case kTransition: {
+      engine.capture();
+      std::vector<CRGB> keyframe = TestPattern(leds.size(), 5);
+      std::copy(keyframe.begin(), keyframe.end(), leds.begin());
+      engine.transition(UINT32_MAX, EffectEngine::kEaseInOutCubic);
+      break;
+    }
+  }
+}
+
+void BM_Effect(benchmark::State& state, Effect effect) {
+  ResetHost();
+  size_t num_leds = state.range(0);
+  std::vector<CRGB> leds = TestPattern(num_leds);
+  std::vector<CRGB> from(num_leds), target(num_leds), storage(3 * num_leds);
+  FrameSlot slot(storage.data(), num_leds);
+  EffectEngine engine(leds.data(), from.data(), target.data(), num_leds, slot);
+  Start(engine, effect, leds);
+
+  for (auto _ : state) {
+    if (!engine.running()) Start(engine, effect, leds);
+    host_clock::advance_ms(EffectEngine::FRAME_INTERVAL_MS);
+    engine.render(millis());
+    benchmark::DoNotOptimize(leds.data());
+  }
+  state.counters["frames/s"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK_CAPTURE(BM_Effect, solid, kSolid)->Arg(256)->Arg(1024);
+BENCHMARK_CAPTURE(BM_Effect, gradient, kGradient)->Arg(256)->Arg(1024);
+BENCHMARK_CAPTURE(BM_Effect, hue, kHue)->Arg(256)->Arg(1024);
+BENCHMARK_CAPTURE(BM_Effect, chase, kChase)->Arg(256)->Arg(1024);
+BENCHMARK_CAPTURE(BM_Effect, sparkle, kSparkle)->Arg(256)->Arg(1024);
+BENCHMARK_CAPTURE(BM_Effect, fade, kFade)->Arg(256)->Arg(1024);
+BENCHMARK_CAPTURE(BM_Effect, transition, kTransition)->Arg(256)->Arg(1024);
+
+}  // namespace
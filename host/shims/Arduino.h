@@ -0,0 +1,173 @@
+#pragma once
+
+// Host stand-in for the parts of the arduino-pico core the firmware uses.
+// Time only moves when the test advances it (see host_clock.h) or the code
+// under test calls delay(), so runs are deterministic.
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+#define RISING 3
+#define FALLING 2
+#define CHANGE 4
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+// Pins keep the last level written, which is also what digitalRead() returns,
+// so tests drive inputs with digitalWrite()
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+void attachInterrupt(int interrupt, void (*handler)(), int mode);
+void noInterrupts();
+void interrupts();
+
+class Print {
+ public:
+  virtual ~Print() = default;
+
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size);
+  size_t write(const char* str) {
+    return write(reinterpret_cast<const uint8_t*>(str), strlen(str));
+  }
+  size_t write(const char* buffer, size_t size) {
+    return write(reinterpret_cast<const uint8_t*>(buffer), size);
+  }
+  virtual int availableForWrite() { return 0; }
+  virtual void flush() {}
+
+  size_t print(const char* str) { return write(str); }
+  size_t print(char c) { return write(static_cast<uint8_t>(c)); }
+  size_t print(unsigned char value) { return print(0ul + value); }
+  size_t print(int value) { return print(0l + value); }
+  size_t print(unsigned int value) { return print(0ul + value); }
+  size_t print(long value);
+  size_t print(unsigned long value);
+  size_t print(double value, int digits = 2);
+
+  size_t println() { return write("\r\n"); }
+  template <typename T>
+  size_t println(T value) {
+    size_t n = print(value);
+    return n + println();
+  }
+
+  size_t printf(const char* format, ...)
+      __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  size_t readBytes(char* buffer, size_t length);
+  size_t readBytes(uint8_t* buffer, size_t length) {
+    return readBytes(reinterpret_cast<char*>(buffer), length);
+  }
+};
+
+class HardwareSerial : public Stream {
+ public:
+  virtual void begin(unsigned long baud) {}
+  virtual void end() {}
+  virtual operator bool() { return true; }
+};
+
+class SerialUART;
+
+// Something on the far end of a SerialUART, such as a fake CH9121, that sees
+// every byte the firmware writes
+class UartPeer {
+ public:
+  virtual ~UartPeer() = default;
+  virtual void on_write(SerialUART& uart, const uint8_t* data,
+                        size_t size) = 0;
+
+  // Called whenever the firmware checks for received data, to deliver any
+  // that is due
+  virtual void poll(SerialUART& uart) {}
+};
+
+// Hardware UART. Bytes the firmware reads are queued with inject(), bytes it
+// writes are recorded in output() and passed on to the peer, if any.
+class SerialUART : public HardwareSerial {
+ public:
+  void setTX(uint8_t pin) {}
+  void setRX(uint8_t pin) {}
+  bool setFIFOSize(size_t size) { return true; }
+
+  void begin(unsigned long baud) override;
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  int availableForWrite() override { return write_space_; }
+
+  // Host side
+  void inject(std::string_view data) {
+    rx_.insert(rx_.end(), data.begin(), data.end());
+  }
+  const std::string& output() const { return tx_; }
+  std::string take_output() { return std::exchange(tx_, std::string()); }
+  void set_peer(UartPeer* peer) { peer_ = peer; }
+  void set_write_space(int space) { write_space_ = space; }
+  unsigned long baud() const { return baud_; }
+  uint64_t bytes_written() const { return bytes_written_; }
+  void reset();
+
+ private:
+  std::deque<uint8_t> rx_;
+  std::string tx_;
+  UartPeer* peer_ = nullptr;
+  int write_space_ = 4096;
+  unsigned long baud_ = 0;
+  uint64_t bytes_written_ = 0;
+};
+
+// USB CDC port used for diagnostics. Output is recorded in output().
+class SerialUSB : public HardwareSerial {
+ public:
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  int availableForWrite() override { return 256; }
+
+  // Host side
+  const std::string& output() const { return tx_; }
+  std::string take_output() { return std::exchange(tx_, std::string()); }
+
+ private:
+  std::string tx_;
+};
+
+extern SerialUSB Serial;
+extern SerialUART Serial1;
+extern SerialUART Serial2;
@@ -0,0 +1,138 @@
+#pragma once
+
+// Host stand-in for the FastLED types and helpers the firmware uses. The
+// 8-bit math follows FastLED's portable C implementations; hsv2rgb_rainbow is
+// approximated by a plain HSV spectrum. show() records the frames sent to
+// each registered strip and advances the clock by their WS2812 transfer time.
+
+#include <Arduino.h>
+
+#include <deque>
+#include <vector>
+
+typedef uint8_t fract8;
+
+struct CHSV {
+  uint8_t h = 0;
+  uint8_t s = 0;
+  uint8_t v = 0;
+
+  CHSV() = default;
+  constexpr CHSV(uint8_t hue, uint8_t sat, uint8_t val)
+      : h(hue), s(sat), v(val) {}
+};
+
+struct CRGB {
+  union {
+    struct {
+      uint8_t r;
+      uint8_t g;
+      uint8_t b;
+    };
+    uint8_t raw[3];
+  };
+
+  enum HTMLColorCode : uint32_t {
+    Black = 0x000000,
+    Blue = 0x0000FF,
+    Green = 0x008000,
+    Red = 0xFF0000,
+    White = 0xFFFFFF,
+  };
+
+  CRGB() = default;
+  constexpr CRGB(uint8_t red, uint8_t green, uint8_t blue)
+      : r(red), g(green), b(blue) {}
+  constexpr CRGB(uint32_t code)
+      : r((code >> 16) & 0xFF), g((code >> 8) & 0xFF), b(code & 0xFF) {}
+  constexpr CRGB(HTMLColorCode code) : CRGB(uint32_t{code}) {}
+  CRGB(const CHSV& hsv);
+
+  uint8_t& operator[](uint8_t index) { return raw[index]; }
+  const uint8_t& operator[](uint8_t index) const { return raw[index]; }
+};
+
+inline bool operator==(const CRGB& lhs, const CRGB& rhs) {
+  return lhs.r == rhs.r && lhs.g == rhs.g && lhs.b == rhs.b;
+}
+inline bool operator!=(const CRGB& lhs, const CRGB& rhs) {
+  return !(lhs == rhs);
+}
+
+uint8_t scale8(uint8_t i, fract8 scale);
+uint8_t blend8(uint8_t a, uint8_t b, uint8_t amount_of_b);
+uint8_t ease8InOutQuad(uint8_t i);
+uint8_t ease8InOutCubic(fract8 i);
+uint8_t random8();
+uint8_t random8(uint8_t lim);
+uint16_t random16();
+uint16_t random16(uint16_t lim);
+void random16_set_seed(uint16_t seed);
+
+void hsv2rgb_rainbow(const CHSV& hsv, CRGB& rgb);
+inline CRGB::CRGB(const CHSV& hsv) { hsv2rgb_rainbow(hsv, *this); }
+
+CRGB& nblend(CRGB& existing, const CRGB& overlay, fract8 amount_of_overlay);
+CRGB blend(const CRGB& p1, const CRGB& p2, fract8 amount_of_p2);
+void fill_solid(CRGB* leds, int num_leds, const CRGB& color);
+void fill_gradient_RGB(CRGB* leds, uint16_t start_pos, CRGB start_color,
+                       uint16_t end_pos, CRGB end_color);
+void fill_gradient_RGB(CRGB* leds, uint16_t num_leds, const CRGB& c1,
+                       const CRGB& c2);
+void fadeToBlackBy(CRGB* leds, uint16_t num_leds, uint8_t fade_by);
+
+template <uint8_t DATA_PIN>
+class NEOPIXEL {};
+
+class CLEDController {
+ public:
+  CLEDController(uint8_t pin, CRGB* leds, int num_leds)
+      : pin_(pin), leds_(leds), num_leds_(num_leds) {}
+
+  uint8_t pin() const { return pin_; }
+  CRGB* leds() const { return leds_; }
+  int size() const { return num_leds_; }
+
+  // Copy of the LEDs as of the last show()
+  const std::vector<CRGB>& shown() const { return shown_; }
+
+ private:
+  friend class CFastLED;
+  uint8_t pin_;
+  CRGB* leds_;
+  int num_leds_;
+  std::vector<CRGB> shown_;
+};
+
+class CFastLED {
+ public:
+  // WS2812 bit time is 1.25 us, so one LED takes 30 us, and a frame ends with
+  // a reset gap
+  static constexpr uint32_t LED_US = 30;
+  static constexpr uint32_t RESET_US = 50;
+
+  template <template <uint8_t> class CHIPSET, uint8_t DATA_PIN>
+  CLEDController& addLeds(CRGB* leds, int num_leds) {
+    return add(DATA_PIN, leds, num_leds);
+  }
+
+  // Lanes are clocked out in parallel, so a frame takes as long as the
+  // longest lane
+  void show();
+  void setBrightness(uint8_t scale) {}
+
+  // Host side
+  const std::deque<CLEDController>& controllers() const {
+    return controllers_;
+  }
+  uint64_t shows() const { return shows_; }
+  void reset();
+
+ private:
+  std::deque<CLEDController> controllers_;
+  uint64_t shows_ = 0;
+
+  CLEDController& add(uint8_t pin, CRGB* leds, int num_leds);
+};
+
+extern CFastLED FastLED;
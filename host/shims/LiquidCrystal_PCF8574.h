@@ -0,0 +1,50 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// HD44780 character LCD behind a PCF8574, as driven by the
+// LiquidCrystal_PCF8574 library: every command or character is one I2C
+// transaction of four bytes (two nibbles, each latched with an enable pulse).
+// The shim keeps the display contents so tests can check what is shown.
+class LiquidCrystal_PCF8574 : public Print {
+ public:
+  static constexpr uint8_t MAX_COLS = 20;
+  static constexpr uint8_t MAX_ROWS = 4;
+
+  explicit LiquidCrystal_PCF8574(uint8_t address) : address_(address) {
+    clear_cells();
+  }
+
+  void begin(uint8_t cols, uint8_t rows, TwoWire& wire = Wire);
+  void setBacklight(uint8_t brightness);
+  void home();
+  void clear();
+  void setCursor(uint8_t col, uint8_t row);
+  size_t write(uint8_t c) override;
+  using Print::write;
+
+  // Host side
+  std::string_view row(uint8_t row) const {
+    return std::string_view(cells_[row], cols_);
+  }
+  uint8_t col() const { return col_; }
+  uint64_t commands() const { return commands_; }
+  uint64_t characters() const { return characters_; }
+
+ private:
+  uint8_t address_;
+  TwoWire* wire_ = &Wire;
+  uint8_t cols_ = MAX_COLS;
+  uint8_t rows_ = MAX_ROWS;
+  uint8_t col_ = 0;
+  uint8_t row_ = 0;
+  char cells_[MAX_ROWS][MAX_COLS];
+  uint64_t commands_ = 0;
+  uint64_t characters_ = 0;
+
+  void clear_cells();
+
+  // Send one command or data byte over I2C
+  void send(uint8_t value, bool is_data);
+};
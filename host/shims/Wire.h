@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <vector>
+
+// A device on the fake I2C bus. on_write() receives the bytes of each write
+// transaction once it ends, on_read() fills the bytes of a read.
+class I2cDevice {
+ public:
+  virtual ~I2cDevice() = default;
+  virtual void on_write(const uint8_t* data, size_t size) = 0;
+  virtual void on_read(uint8_t* data, size_t size) = 0;
+};
+
+// I2C controller that routes transactions to attached I2cDevices, records
+// how many transactions and bytes went over the bus and advances the clock by
+// their transfer time at the configured bus speed.
+class TwoWire : public Stream {
+ public:
+  void setSDA(uint8_t pin) {}
+  void setSCL(uint8_t pin) {}
+  void setClock(uint32_t hz) { clock_hz_ = hz; }
+  void begin() {}
+
+  void beginTransmission(uint8_t address);
+  uint8_t endTransmission(bool stop = true);
+  uint8_t requestFrom(uint8_t address, size_t size, bool stop = true);
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  int available() override { return read_buffer_.size() - read_pos_; }
+  int read() override;
+  int peek() override;
+
+  // Host side
+  void attach(uint8_t address, I2cDevice* device);
+  void reset();
+  uint64_t transactions() const { return transactions_; }
+  uint64_t bytes_written() const { return bytes_written_; }
+  uint64_t bytes_read() const { return bytes_read_; }
+  // Bytes on the bus in either direction, not counting address bytes
+  uint64_t bytes() const { return bytes_written_ + bytes_read_; }
+
+ private:
+  I2cDevice* devices_[128] = {};
+  uint32_t clock_hz_ = 100000;
+  uint8_t address_ = 0;
+  std::vector<uint8_t> write_buffer_;
+  std::vector<uint8_t> read_buffer_;
+  size_t read_pos_ = 0;
+  uint64_t transactions_ = 0;
+  uint64_t bytes_written_ = 0;
+  uint64_t bytes_read_ = 0;
+
+  // Advance the clock by the time to clock out the address and size bytes
+  void transfer(size_t size);
+};
+
+extern TwoWire Wire;
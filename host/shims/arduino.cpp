@@ -0,0 +1,128 @@
+#include <Arduino.h>
+#include <stdarg.h>
+
+#include "host_clock.h"
+
+namespace {
+
+uint64_t clock_us = 0;
+uint32_t tick_us = 0;
+uint8_t pin_levels[64];
+
+}  // namespace
+
+namespace host_clock {
+
+uint64_t now_us() { return clock_us; }
+void advance_us(uint64_t us) { clock_us += us; }
+void set_tick_us(uint32_t us) { tick_us = us; }
+void reset() {
+  clock_us = 0;
+  tick_us = 0;
+}
+
+}  // namespace host_clock
+
+uint32_t millis() {
+  clock_us += tick_us;
+  return clock_us / 1000;
+}
+
+uint32_t micros() {
+  clock_us += tick_us;
+  return clock_us;
+}
+void delay(uint32_t ms) { clock_us += uint64_t{ms} * 1000; }
+void delayMicroseconds(uint32_t us) { clock_us += us; }
+void yield() {}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (mode == INPUT_PULLUP) pin_levels[pin] = HIGH;
+}
+void digitalWrite(uint8_t pin, uint8_t value) { pin_levels[pin] = value; }
+int digitalRead(uint8_t pin) { return pin_levels[pin]; }
+void attachInterrupt(int interrupt, void (*handler)(), int mode) {}
+void noInterrupts() {}
+void interrupts() {}
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t n = 0;
+  while (n < size && write(buffer[n])) ++n;
+  return n;
+}
+
+size_t Print::print(long value) {
+  char text[24];
+  return write(text, snprintf(text, sizeof(text), "%ld", value));
+}
+
+size_t Print::print(unsigned long value) {
+  char text[24];
+  return write(text, snprintf(text, sizeof(text), "%lu", value));
+}
+
+size_t Print::print(double value, int digits) {
+  char text[48];
+  return write(text, snprintf(text, sizeof(text), "%.*f", digits, value));
+}
+
+size_t Print::printf(const char* format, ...) {
+  char text[256];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+  if (length < 0) return 0;
+  return write(text, std::min<size_t>(length, sizeof(text) - 1));
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+  size_t n = 0;
+  while (n < length && available() > 0) buffer[n++] = read();
+  return n;
+}
+
+void SerialUART::begin(unsigned long baud) { baud_ = baud; }
+
+int SerialUART::available() {
+  if (peer_) peer_->poll(*this);
+  return rx_.size();
+}
+
+int SerialUART::read() {
+  if (peer_) peer_->poll(*this);
+  if (rx_.empty()) return -1;
+  uint8_t c = rx_.front();
+  rx_.pop_front();
+  return c;
+}
+
+int SerialUART::peek() {
+  if (peer_) peer_->poll(*this);
+  return rx_.empty() ? -1 : rx_.front();
+}
+
+size_t SerialUART::write(const uint8_t* buffer, size_t size) {
+  tx_.append(reinterpret_cast<const char*>(buffer), size);
+  bytes_written_ += size;
+  if (peer_) peer_->on_write(*this, buffer, size);
+  return size;
+}
+
+void SerialUART::reset() {
+  rx_.clear();
+  tx_.clear();
+  peer_ = nullptr;
+  write_space_ = 4096;
+  baud_ = 0;
+  bytes_written_ = 0;
+}
+
+size_t SerialUSB::write(const uint8_t* buffer, size_t size) {
+  tx_.append(reinterpret_cast<const char*>(buffer), size);
+  return size;
+}
+
+SerialUSB Serial;
+SerialUART Serial1;
+SerialUART Serial2;
@@ -0,0 +1,145 @@
+#include <FastLED.h>
+
+#include "host_clock.h"
+
+namespace {
+
+uint16_t rand16_seed = 1337;
+
+}  // namespace
+
+uint8_t scale8(uint8_t i, fract8 scale) {
+  return (uint16_t{i} * (1 + uint16_t{scale})) >> 8;
+}
+
+uint8_t blend8(uint8_t a, uint8_t b, uint8_t amount_of_b) {
+  uint16_t partial = (uint16_t{a} << 8) | b;
+  partial += uint16_t{b} * amount_of_b;
+  partial -= uint16_t{a} * amount_of_b;
+  return partial >> 8;
+}
+
+uint8_t ease8InOutQuad(uint8_t i) {
+  uint8_t j = i & 0x80 ? 255 - i : i;
+  uint8_t jj2 = scale8(j, j) << 1;
+  return i & 0x80 ? 255 - jj2 : jj2;
+}
+
+uint8_t ease8InOutCubic(fract8 i) {
+  uint8_t ii = scale8(i, i);
+  uint8_t iii = scale8(ii, i);
+  uint16_t r1 = 3 * uint16_t{ii} - 2 * uint16_t{iii};
+  return r1 & 0x100 ? 255 : r1;
+}
+
+uint16_t random16() {
+  rand16_seed = rand16_seed * 2053 + 13849;
+  return rand16_seed;
+}
+
+uint16_t random16(uint16_t lim) {
+  return (uint32_t{random16()} * lim) >> 16;
+}
+
+uint8_t random8() {
+  uint16_t r = random16();
+  return uint8_t(r & 0xFF) + uint8_t(r >> 8);
+}
+
+uint8_t random8(uint8_t lim) { return (uint16_t{random8()} * lim) >> 8; }
+
+void random16_set_seed(uint16_t seed) { rand16_seed = seed; }
+
+void hsv2rgb_rainbow(const CHSV& hsv, CRGB& rgb) {
+  // Six linear sections of 256 / 6 hues each
+  uint16_t position = uint16_t{hsv.h} * 6;
+  uint8_t section = position >> 8;
+  uint8_t rising = position & 0xFF;
+  uint8_t falling = 255 - rising;
+  const uint8_t sections[6][3] = {
+      {255, rising, 0},  {falling, 255, 0}, {0, 255, rising},
+      {0, falling, 255}, {rising, 0, 255},  {255, 0, falling},
+  };
+  uint8_t channels[3];
+  memcpy(channels, sections[section], sizeof(channels));
+  // Desaturate towards white, then scale by value
+  uint8_t white = 255 - hsv.s;
+  for (uint8_t& c : channels) {
+    c = scale8(scale8(c, hsv.s) + white, hsv.v);
+  }
+  rgb = CRGB(channels[0], channels[1], channels[2]);
+}
+
+CRGB& nblend(CRGB& existing, const CRGB& overlay, fract8 amount_of_overlay) {
+  if (amount_of_overlay == 0) return existing;
+  if (amount_of_overlay == 255) return existing = overlay;
+  for (uint8_t i = 0; i < 3; ++i) {
+    existing[i] = blend8(existing[i], overlay[i], amount_of_overlay);
+  }
+  return existing;
+}
+
+CRGB blend(const CRGB& p1, const CRGB& p2, fract8 amount_of_p2) {
+  CRGB result = p1;
+  return nblend(result, p2, amount_of_p2);
+}
+
+void fill_solid(CRGB* leds, int num_leds, const CRGB& color) {
+  for (int i = 0; i < num_leds; ++i) leds[i] = color;
+}
+
+void fill_gradient_RGB(CRGB* leds, uint16_t start_pos, CRGB start_color,
+                       uint16_t end_pos, CRGB end_color) {
+  if (end_pos < start_pos) {
+    std::swap(start_pos, end_pos);
+    std::swap(start_color, end_color);
+  }
+  // Signed 8.7 fixed point steps, applied to 8.8 channel accumulators
+  int16_t divisor = end_pos - start_pos ? end_pos - start_pos : 1;
+  int16_t delta[3];
+  uint16_t accum[3];
+  for (uint8_t c = 0; c < 3; ++c) {
+    delta[c] = ((end_color[c] - start_color[c]) << 7) / divisor * 2;
+    accum[c] = start_color[c] << 8;
+  }
+  for (uint16_t i = start_pos; i <= end_pos; ++i) {
+    leds[i] = CRGB(accum[0] >> 8, accum[1] >> 8, accum[2] >> 8);
+    for (uint8_t c = 0; c < 3; ++c) accum[c] += delta[c];
+  }
+}
+
+void fill_gradient_RGB(CRGB* leds, uint16_t num_leds, const CRGB& c1,
+                       const CRGB& c2) {
+  fill_gradient_RGB(leds, 0, c1, num_leds - 1, c2);
+}
+
+void fadeToBlackBy(CRGB* leds, uint16_t num_leds, uint8_t fade_by) {
+  for (uint16_t i = 0; i < num_leds; ++i) {
+    for (uint8_t c = 0; c < 3; ++c) {
+      leds[i][c] = scale8(leds[i][c], 255 - fade_by);
+    }
+  }
+}
+
+void CFastLED::show() {
+  int longest = 0;
+  for (CLEDController& controller : controllers_) {
+    controller.shown_.assign(controller.leds_,
+                             controller.leds_ + controller.num_leds_);
+    longest = std::max(longest, controller.num_leds_);
+  }
+  ++shows_;
+  host_clock::advance_us(uint64_t{LED_US} * longest + RESET_US);
+}
+
+void CFastLED::reset() {
+  controllers_.clear();
+  shows_ = 0;
+}
+
+CLEDController& CFastLED::add(uint8_t pin, CRGB* leds, int num_leds) {
+  controllers_.emplace_back(pin, leds, num_leds);
+  return controllers_.back();
+}
+
+CFastLED FastLED;
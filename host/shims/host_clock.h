@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stdint.h>
+
+// Simulated time behind millis() and micros(). It starts at zero and moves
+// only when advanced here, by delay(), delayMicroseconds() and the transfer
+// times of the bus shims, and by the tick set with set_tick_us().
+namespace host_clock {
+
+uint64_t now_us();
+void advance_us(uint64_t us);
+inline void advance_ms(uint64_t ms) { advance_us(ms * 1000); }
+// Advance the clock by us on every millis() or micros() call, so code that
+// busy-waits on the time runs to completion
+void set_tick_us(uint32_t us);
+
+void reset();
+
+}  // namespace host_clock
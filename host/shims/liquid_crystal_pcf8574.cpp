@@ -0,0 +1,74 @@
+#include <LiquidCrystal_PCF8574.h>
+
+namespace {
+
+// PCF8574 pins wired to the LCD
+constexpr uint8_t kRegisterSelect = 0x01;
+constexpr uint8_t kEnable = 0x04;
+constexpr uint8_t kBacklight = 0x08;
+
+// Execution time of clear and home, which the library waits out
+constexpr uint32_t kClearUs = 1600;
+
+}  // namespace
+
+void LiquidCrystal_PCF8574::begin(uint8_t cols, uint8_t rows, TwoWire& wire) {
+  cols_ = std::min(cols, MAX_COLS);
+  rows_ = std::min(rows, MAX_ROWS);
+  wire_ = &wire;
+  clear();
+}
+
+void LiquidCrystal_PCF8574::setBacklight(uint8_t brightness) {
+  wire_->beginTransmission(address_);
+  wire_->write(brightness ? kBacklight : 0);
+  wire_->endTransmission();
+}
+
+void LiquidCrystal_PCF8574::home() {
+  send(0x02, false);
+  delayMicroseconds(kClearUs);
+  col_ = 0;
+  row_ = 0;
+}
+
+void LiquidCrystal_PCF8574::clear() {
+  send(0x01, false);
+  delayMicroseconds(kClearUs);
+  clear_cells();
+  col_ = 0;
+  row_ = 0;
+}
+
+void LiquidCrystal_PCF8574::setCursor(uint8_t col, uint8_t row) {
+  static constexpr uint8_t kRowOffsets[] = {0x00, 0x40, 0x14, 0x54};
+  row_ = std::min<uint8_t>(row, rows_ - 1);
+  col_ = col;
+  send(0x80 | (kRowOffsets[row_] + col_), false);
+}
+
+size_t LiquidCrystal_PCF8574::write(uint8_t c) {
+  send(c, true);
+  if (col_ < cols_) cells_[row_][col_] = c;
+  ++col_;
+  return 1;
+}
+
+void LiquidCrystal_PCF8574::clear_cells() {
+  memset(cells_, ' ', sizeof(cells_));
+}
+
+void LiquidCrystal_PCF8574::send(uint8_t value, bool is_data) {
+  if (is_data) {
+    ++characters_;
+  } else {
+    ++commands_;
+  }
+  uint8_t flags = kBacklight | (is_data ? kRegisterSelect : 0);
+  wire_->beginTransmission(address_);
+  for (uint8_t nibble : {uint8_t(value >> 4), uint8_t(value & 0x0F)}) {
+    wire_->write((nibble << 4) | flags | kEnable);
+    wire_->write((nibble << 4) | flags);
+  }
+  wire_->endTransmission();
+}
@@ -0,0 +1,76 @@
+#include <Wire.h>
+
+#include "host_clock.h"
+
+void TwoWire::beginTransmission(uint8_t address) {
+  address_ = address & 0x7F;
+  write_buffer_.clear();
+}
+
+uint8_t TwoWire::endTransmission(bool stop) {
+  ++transactions_;
+  bytes_written_ += write_buffer_.size();
+  transfer(write_buffer_.size());
+  I2cDevice* device = devices_[address_];
+  if (!device) return 2;  // Address not acknowledged
+  device->on_write(write_buffer_.data(), write_buffer_.size());
+  return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, size_t size, bool stop) {
+  ++transactions_;
+  read_buffer_.clear();
+  read_pos_ = 0;
+  I2cDevice* device = devices_[address & 0x7F];
+  if (!device) {
+    transfer(0);
+    return 0;
+  }
+  read_buffer_.resize(size);
+  device->on_read(read_buffer_.data(), size);
+  bytes_read_ += size;
+  transfer(size);
+  return size;
+}
+
+size_t TwoWire::write(uint8_t c) {
+  write_buffer_.push_back(c);
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t* buffer, size_t size) {
+  write_buffer_.insert(write_buffer_.end(), buffer, buffer + size);
+  return size;
+}
+
+int TwoWire::read() {
+  if (read_pos_ == read_buffer_.size()) return -1;
+  return read_buffer_[read_pos_++];
+}
+
+int TwoWire::peek() {
+  if (read_pos_ == read_buffer_.size()) return -1;
+  return read_buffer_[read_pos_];
+}
+
+void TwoWire::attach(uint8_t address, I2cDevice* device) {
+  devices_[address & 0x7F] = device;
+}
+
+void TwoWire::reset() {
+  for (I2cDevice*& device : devices_) device = nullptr;
+  write_buffer_.clear();
+  read_buffer_.clear();
+  read_pos_ = 0;
+  transactions_ = 0;
+  bytes_written_ = 0;
+  bytes_read_ = 0;
+}
+
+void TwoWire::transfer(size_t size) {
+  // Start, address byte, data bytes and stop, 9 clocks per byte with the ACK
+  uint64_t bits = 2 + 9 * (size + 1);
+  host_clock::advance_us(bits * 1000000 / clock_hz_);
+}
+
+TwoWire Wire;
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <map>
+#include <vector>
+
+#include "host_clock.h"
+
+// CH9121 serial-to-Ethernet module on a SerialUART. With its CFG pin low and
+// the UART at 9600 baud it answers 0x57 0xAB configuration commands after
+// ready_ms, each reply reply_us after the command; otherwise bytes written
+// are network traffic. Replies are delivered as the firmware polls the UART
+// once they are due.
+class FakeCh9121 : public UartPeer {
+ public:
+  FakeCh9121(SerialUART& uart, uint8_t cfg_pin)
+      : uart_(uart), cfg_pin_(cfg_pin) {
+    uart_.set_peer(this);
+  }
+  ~FakeCh9121() override { uart_.set_peer(nullptr); }
+
+  uint32_t ready_ms = 200;
+  uint32_t reply_us = 2000;
+
+  // Stored setting for a query command, in the module's byte order
+  std::vector<uint8_t>& setting(uint8_t query) { return settings_[query]; }
+
+  void on_write(SerialUART& uart, const uint8_t* data, size_t size) override {
+    bool config_mode = digitalRead(cfg_pin_) == LOW && uart.baud() == 9600;
+    if (!config_mode) {
+      in_config_ = false;
+      network_.append(reinterpret_cast<const char*>(data), size);
+      return;
+    }
+    if (!in_config_) {
+      in_config_ = true;
+      ready_at_us_ = host_clock::now_us() + uint64_t{ready_ms} * 1000;
+      command_.clear();
+    }
+    for (size_t i = 0; i < size; ++i) receive(data[i]);
+  }
+
+  void poll(SerialUART& uart) override {
+    uint64_t now = host_clock::now_us();
+    while (!replies_.empty() && replies_.front().first <= now) {
+      uart_.inject(replies_.front().second);
+      replies_.erase(replies_.begin());
+    }
+  }
+
+  // Commands answered, and set commands among them
+  int commands() const { return commands_; }
+  int writes() const { return writes_; }
+  int saves() const { return saves_; }
+  const std::string& network() const { return network_; }
+
+ private:
+  SerialUART& uart_;
+  uint8_t cfg_pin_;
+  bool in_config_ = false;
+  uint64_t ready_at_us_ = 0;
+  std::vector<uint8_t> command_;
+  std::map<uint8_t, std::vector<uint8_t>> settings_ = {
+      {0x60, {0}},          {0x61, {0, 0, 0, 0}}, {0x62, {0, 0, 0, 0}},
+      {0x63, {0, 0, 0, 0}}, {0x64, {0, 0}},       {0x65, {0, 0, 0, 0}},
+      {0x66, {0, 0}},       {0x71, {0, 0, 0, 0}},
+  };
+  std::vector<std::pair<uint64_t, std::string>> replies_;
+  int commands_ = 0;
+  int writes_ = 0;
+  int saves_ = 0;
+  std::string network_;
+
+  // Data bytes following a command byte
+  static size_t data_length(uint8_t command) {
+    switch (command) {
+      case 0x10:
+        return 1;
+      case 0x14:
+      case 0x16:
+        return 2;
+      case 0x11:
+      case 0x12:
+      case 0x13:
+      case 0x15:
+      case 0x21:
+        return 4;
+      default:
+        return 0;
+    }
+  }
+
+  void receive(uint8_t byte) {
+    command_.push_back(byte);
+    if (command_.size() == 1 && byte != 0x57) command_.clear();
+    if (command_.size() == 2 && byte != 0xAB) command_.clear();
+    if (command_.size() < 3) return;
+    uint8_t command = command_[2];
+    if (command_.size() < 3 + data_length(command)) return;
+    std::vector<uint8_t> data(command_.begin() + 3, command_.end());
+    command_.clear();
+
+    // Not yet booted into configuration mode
+    if (host_clock::now_us() < ready_at_us_) return;
+
+    ++commands_;
+    std::string reply(1, char(0xAA));
+    if (settings_.count(command)) {
+      reply.assign(settings_[command].begin(), settings_[command].end());
+    } else if (command >= 0x10 && command <= 0x21 && !data.empty()) {
+      ++writes_;
+      uint8_t query = command == 0x21 ? 0x71 : command + 0x50;
+      settings_[query] = data;
+    } else if (command == 0x0D) {
+      ++saves_;
+    }
+    replies_.emplace_back(host_clock::now_us() + reply_us, reply);
+  }
+};
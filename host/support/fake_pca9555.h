@@ -0,0 +1,45 @@
+#pragma once
+
+#include <Wire.h>
+
+// Register model of a PCA9555 on the fake I2C bus. The command byte selects a
+// register, and further bytes of a transaction move within its register pair.
+// Input registers read the levels set with set_inputs() on input pins and the
+// output registers on output pins.
+class FakePca9555 : public I2cDevice {
+ public:
+  void on_write(const uint8_t* data, size_t size) override {
+    if (size == 0) return;
+    pointer_ = data[0] & 0x07;
+    for (size_t i = 1; i < size; ++i) {
+      if (pointer_ >= 2) registers_[pointer_] = data[i];
+      pointer_ ^= 1;
+    }
+  }
+
+  void on_read(uint8_t* data, size_t size) override {
+    for (size_t i = 0; i < size; ++i) {
+      data[i] = value(pointer_);
+      pointer_ ^= 1;
+    }
+  }
+
+  // Levels on the 16 pins, port 1 in the high byte
+  void set_inputs(uint16_t levels) { inputs_ = levels; }
+
+  uint8_t output(uint8_t port) const { return registers_[2 + port]; }
+  uint8_t config(uint8_t port) const { return registers_[6 + port]; }
+  uint8_t pointer() const { return pointer_; }
+
+ private:
+  uint8_t registers_[8] = {0, 0, 0xFF, 0xFF, 0, 0, 0xFF, 0xFF};
+  uint8_t pointer_ = 0;
+  uint16_t inputs_ = 0xFFFF;
+
+  uint8_t value(uint8_t reg) const {
+    if (reg >= 2) return registers_[reg];
+    uint8_t inputs = inputs_ >> (8 * reg);
+    uint8_t config = registers_[6 + reg];
+    return (inputs & config) | (registers_[2 + reg] & ~config);
+  }
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <Wire.h>
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "crc16.h"
+#include "host_clock.h"
+
+// Helpers shared by the host tests and benchmarks
+
+// Put the clock, buses and serial ports back in their power-on state
+inline void ResetHost() {
+  host_clock::reset();
+  Wire.reset();
+  Serial.take_output();
+  Serial1.reset();
+  Serial2.reset();
+  FastLED.reset();
+  random16_set_seed(1337);
+}
+
+inline std::string Base64Encode(std::string_view data) {
+  static constexpr char kAlphabet[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string out;
+  for (size_t i = 0; i < data.size(); i += 3) {
+    uint32_t group = uint8_t(data[i]) << 16;
+    if (i + 1 < data.size()) group |= uint8_t(data[i + 1]) << 8;
+    if (i + 2 < data.size()) group |= uint8_t(data[i + 2]);
+    out += kAlphabet[group >> 18];
+    out += kAlphabet[(group >> 12) & 0x3F];
+    out += i + 1 < data.size() ? kAlphabet[(group >> 6) & 0x3F] : '=';
+    out += i + 2 < data.size() ? kAlphabet[group & 0x3F] : '=';
+  }
+  return out;
+}
+
+// LedCommand payload: LED count, then r, g, b per LED
+inline std::string LedPayload(const std::vector<CRGB>& leds) {
+  std::string payload = {char(leds.size() & 0xFF), char(leds.size() >> 8)};
+  for (const CRGB& led : leds) {
+    payload += char(led.r);
+    payload += char(led.g);
+    payload += char(led.b);
+  }
+  return payload;
+}
+
+// Binary frame of the given type around payload, see command.h
+inline std::string BinaryFrame(uint8_t type, std::string_view payload) {
+  std::string frame = {char(0xA5), char(type), char(payload.size() & 0xFF),
+                       char(payload.size() >> 8)};
+  frame += payload;
+  uint16_t crc = kCrc16Init;
+  for (size_t i = 1; i < frame.size(); ++i) crc = Crc16Update(crc, frame[i]);
+  frame += char(crc & 0xFF);
+  frame += char(crc >> 8);
+  return frame;
+}
+
+// LEDs with a different colour each
+inline std::vector<CRGB> TestPattern(size_t count, uint8_t seed = 0) {
+  std::vector<CRGB> leds(count);
+  for (size_t i = 0; i < count; ++i) {
+    leds[i] = CRGB(i + seed, i * 3 + seed, i * 7 + seed);
+  }
+  return leds;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <Arduino.h>
+#include <stddef.h>
+
+#include <array>
+#include <span>
+#include <string_view>
+
+#include "command.h"
+
+// CommandProcessor's handling of text lines as it was before the dispatch
+// tables, comparing every registered prefix against each line. Per-character
+// work (timeout clock, frame sync check, buffering and latency recording) is as
+// in CommandProcessor, so the two only differ in how a line finds its command.
+// Kept as the baseline in the dispatch benchmark. Streaming commands get their
+// arguments a character at a time and binary frames are not handled, so the
+// benchmark sends neither.
+class LinearCommandProcessor {
+ public:
+  LinearCommandProcessor(std::span<Command*> commands, Print& log)
+      : commands_(commands), log_(log) {}
+
+  void process_chars(std::string_view chars) {
+    if (chars.empty()) return;
+    last_input_us_ = micros();
+    for (char c : chars) process_char(c);
+  }
+
+ private:
+  std::span<Command*> commands_;
+  Print& log_;
+  std::array<char, 256> buffer_;
+  size_t buffer_pos_ = 0;
+  bool truncated_ = false;
+  uint32_t lines_truncated_ = 0;
+  uint32_t last_input_us_ = 0;
+  Command* streaming_ = nullptr;
+
+  void process_char(char c) {
+    if (streaming_) {
+      if (c == '\n') {
+        streaming_->end_stream();
+        streaming_ = nullptr;
+      } else {
+        streaming_->stream(std::string_view(&c, 1));
+      }
+      return;
+    }
+    if (buffer_pos_ == 0 && static_cast<uint8_t>(c) == kFrameSync) return;
+    if (c == '\n') {
+      if (truncated_) {
+        ++lines_truncated_;
+        truncated_ = false;
+      }
+      process_command(std::string_view(buffer_.data(), buffer_pos_));
+      buffer_pos_ = 0;
+    } else if (buffer_pos_ < buffer_.size()) {
+      if (c == ':') {
+        Command* cmd = find_streaming_command(
+            std::string_view(buffer_.data(), buffer_pos_));
+        if (cmd) {
+          streaming_ = cmd;
+          buffer_pos_ = 0;
+          cmd->begin_stream();
+          return;
+        }
+      }
+      buffer_[buffer_pos_++] = c;
+    } else {
+      truncated_ = true;
+    }
+  }
+
+  Command* find_streaming_command(std::string_view prefix) {
+    for (Command* cmd : commands_) {
+      if (cmd->prefix() == prefix) return cmd->streaming() ? cmd : nullptr;
+    }
+    return nullptr;
+  }
+
+  void process_command(std::string_view line) {
+    for (Command* cmd : commands_) {
+      std::string_view cmd_prefix = cmd->prefix();
+      if (line.size() >= cmd_prefix.size() &&
+          line.substr(0, cmd_prefix.size()) == cmd_prefix) {
+        std::string_view args;
+        if (line.size() > cmd_prefix.size()) {
+          if (line[cmd_prefix.size()] == ':') {
+            args = line.substr(cmd_prefix.size() + 1);
+          } else {
+            continue;
+          }
+        }
+        uint32_t start = micros();
+        cmd->process(args);
+        cmd->latency().record(micros() - start);
+        return;
+      }
+    }
+    log_.write("Unknown command: ", 17);
+    log_.write(line.data(), line.size());
+    log_.write('\n');
+  }
+};
@@ -0,0 +1,49 @@
+#include "backlight_command.h"
+
+#include <Wire.h>
+#include <gtest/gtest.h>
+
+#include "fake_pca9555.h"
+#include "host_test.h"
+#include "pca9555.h"
+
+namespace {
+
+class BacklightCommandTest : public HostTest {
+ protected:
+  void SetUp() override {
+    Wire.attach(PCA9555::I2C_ADDR, &chip_);
+    pca_.begin();
+  }
+
+  FakePca9555 chip_;
+  PCA9555 pca_;
+  BacklightCommand command_{pca_};
+};
+
+TEST_F(BacklightCommandTest, SetsLedOutputs) {
+  command_.process("1:0:1:0:0:1");
+
+  // LEDs 0-3 are on port 0 pins 0, 2, 4 and 6, LEDs 4-5 on port 1 pins 0, 2
+  EXPECT_EQ(chip_.output(0), 0b00010001);
+  EXPECT_EQ(chip_.output(1), 0b00000100);
+}
+
+TEST_F(BacklightCommandTest, RepeatedStatesCauseNoI2cTraffic) {
+  command_.process("1:1:1:1:1:1");
+  uint64_t transactions = Wire.transactions();
+
+  command_.process("1:1:1:1:1:1");
+
+  EXPECT_EQ(Wire.transactions(), transactions);
+}
+
+TEST_F(BacklightCommandTest, SkipsInvalidStatesAndTurnsMissingOnesOff) {
+  command_.process("1:1:1:1:1:1");
+  command_.process("1:x:1");
+
+  EXPECT_EQ(chip_.output(0), 0b00000101);
+  EXPECT_EQ(chip_.output(1), 0);
+}
+
+}  // namespace
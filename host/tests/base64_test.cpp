@@ -0,0 +1,103 @@
+#include "base64.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "base64_reference.h"
+#include "host_support.h"
+
+namespace {
+
+std::span<const uint8_t> Bytes(const std::string& str) {
+  return {reinterpret_cast<const uint8_t*>(str.data()), str.size()};
+}
+
+// Base64 text with the kinds of damage the decoders must agree on: line
+// breaks and spaces, stray padding, invalid characters and truncation
+std::string RandomInput(std::mt19937& rng) {
+  std::string data(rng() % 64, '\0');
+  for (char& c : data) c = rng();
+  std::string text = Base64Encode(data);
+  switch (rng() % 6) {
+    case 0:
+      break;
+    case 1:
+      for (int n = rng() % 4; n > 0 && !text.empty(); --n) {
+        text.insert(rng() % text.size(), 1, " \r\n="[rng() % 4]);
+      }
+      break;
+    case 2:
+      if (!text.empty()) text[rng() % text.size()] = "*-_.\x80"[rng() % 5];
+      break;
+    case 3:
+      text.resize(rng() % (text.size() + 1));
+      break;
+    case 4:
+      if (!text.empty()) text.back() = 'B';
+      break;
+    default:
+      for (char& c : text) c = rng() % 128;
+      break;
+  }
+  return text;
+}
+
+TEST(Base64Test, DecodesLikeTheReferenceDecoder) {
+  std::mt19937 rng(4004);
+  for (int i = 0; i < 200000; ++i) {
+    std::string text = RandomInput(rng);
+    // Output buffers from too small to ample
+    size_t out_size = rng() % (text.size() * 3 / 4 + 4);
+    std::vector<uint8_t> expected(out_size, 0xEE);
+    std::vector<uint8_t> actual(out_size, 0xEE);
+
+    bool expected_ok = ReferenceBase64Decode(Bytes(text), expected);
+    bool actual_ok = Base64Decode(Bytes(text), actual);
+
+    ASSERT_EQ(actual_ok, expected_ok) << '"' << text << "\" into " << out_size;
+    if (expected_ok) {
+      ASSERT_EQ(actual, expected) << '"' << text << '"';
+    }
+  }
+}
+
+TEST(Base64Test, DecodesTheSameInAnyChunks) {
+  std::mt19937 rng(4005);
+  for (int i = 0; i < 20000; ++i) {
+    std::string text = RandomInput(rng);
+    std::vector<uint8_t> whole(text.size());
+    std::vector<uint8_t> chunked(text.size());
+
+    Base64Decoder decoder;
+    int whole_size = decoder.Decode(Bytes(text), whole);
+    bool whole_ok = whole_size >= 0 && decoder.Finish();
+
+    decoder.Reset();
+    int chunked_size = 0;
+    for (size_t pos = 0; pos < text.size() && chunked_size >= 0;) {
+      size_t length = std::min<size_t>(1 + rng() % 9, text.size() - pos);
+      int count = decoder.Decode(Bytes(text.substr(pos, length)),
+                                 std::span(chunked).subspan(chunked_size));
+      chunked_size = count < 0 ? -1 : chunked_size + count;
+      pos += length;
+    }
+    bool chunked_ok = chunked_size >= 0 && decoder.Finish();
+
+    ASSERT_EQ(chunked_ok, whole_ok) << '"' << text << '"';
+    if (whole_ok) {
+      ASSERT_EQ(chunked_size, whole_size);
+      ASSERT_EQ(chunked, whole);
+    }
+  }
+}
+
+TEST(Base64Test, SkipsWhitespace) {
+  uint8_t out[6];
+  ASSERT_TRUE(Base64Decode(Bytes("TW Fu\r\nTWFu\n"), out));
+  EXPECT_EQ(std::string(out, out + 6), "ManMan");
+}
+
+}  // namespace
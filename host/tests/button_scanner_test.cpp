@@ -0,0 +1,127 @@
+#include "button_scanner.h"
+
+#include <Wire.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "fake_pca9555.h"
+#include "host_test.h"
+
+namespace {
+
+constexpr uint8_t kIntPin = 2;
+
+class ButtonScannerTest : public HostTest {
+ protected:
+  void SetUp() override {
+    Wire.attach(PCA9555::I2C_ADDR, &chip_);
+    pca_.begin();
+    scanner_.begin();
+  }
+
+  // Set the pressed buttons (bit i for button i) and raise INT, which the
+  // sketch's interrupt handler passes on with notify(). Returns the time of
+  // the change; each read of the chip takes some time on the bus.
+  uint32_t Press(uint8_t buttons) {
+    static constexpr uint8_t kPins[] = {1, 3, 5, 7, 9, 11};
+    uint16_t levels = 0xFFFF;  // Active low
+    for (int i = 0; i < 6; ++i) {
+      if (buttons & (1 << i)) levels &= ~(1 << kPins[i]);
+    }
+    chip_.set_inputs(levels);
+    scanner_.notify();
+    uint32_t now = millis();
+    scanner_.poll(now);
+    return now;
+  }
+
+  // Poll once a millisecond for ms
+  void PollFor(uint32_t ms) {
+    for (uint32_t i = 0; i < ms; ++i) {
+      host_clock::advance_ms(1);
+      scanner_.poll(millis());
+    }
+  }
+
+  std::vector<ButtonEvent> Events() {
+    std::vector<ButtonEvent> events;
+    ButtonEvent event;
+    while (scanner_.pop(event)) events.push_back(event);
+    return events;
+  }
+
+  FakePca9555 chip_;
+  PCA9555 pca_;
+  ButtonScanner scanner_{pca_, kIntPin};
+};
+
+TEST_F(ButtonScannerTest, QueuesADebouncedPressWithItsFirstTime) {
+  host_clock::advance_ms(100);
+  uint32_t pressed = Press(0b100001);
+  PollFor(ButtonScanner::DEBOUNCE_MS - 2);
+  EXPECT_EQ(scanner_.state(), 0);
+
+  PollFor(2);
+  std::vector<ButtonEvent> events = Events();
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].state, 0b100001);
+  EXPECT_EQ(events[0].time_ms, pressed);
+  EXPECT_EQ(scanner_.state(), 0b100001);
+}
+
+TEST_F(ButtonScannerTest, IgnoresABounceBackToTheStableState) {
+  Press(0b1);
+  PollFor(3);
+  Press(0);
+  PollFor(2 * ButtonScanner::DEBOUNCE_MS);
+
+  EXPECT_TRUE(Events().empty());
+  EXPECT_EQ(scanner_.state(), 0);
+}
+
+TEST_F(ButtonScannerTest, SettlesOnTheLastStateOfABounce) {
+  uint32_t pressed = Press(0b10);
+  PollFor(2);
+  Press(0);
+  PollFor(2);
+  Press(0b10);
+  PollFor(2 * ButtonScanner::DEBOUNCE_MS);
+
+  std::vector<ButtonEvent> events = Events();
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].state, 0b10);
+  EXPECT_EQ(events[0].time_ms, pressed);
+}
+
+TEST_F(ButtonScannerTest, ReadsTheChipOnlyWhenInputsChange) {
+  uint64_t transactions = Wire.transactions();
+  PollFor(100);
+  EXPECT_EQ(Wire.transactions(), transactions);
+
+  // Once the change has settled, the chip is left alone again
+  Press(0b1);
+  PollFor(2 * ButtonScanner::DEBOUNCE_MS);
+  transactions = Wire.transactions();
+  PollFor(100);
+  EXPECT_EQ(Wire.transactions(), transactions);
+  EXPECT_EQ(scanner_.state(), 0b1);
+}
+
+TEST_F(ButtonScannerTest, FullQueueDropsTheOldestEvents) {
+  constexpr size_t kChanges = ButtonScanner::MAX_EVENTS + 4;
+  std::vector<uint32_t> times;
+  for (size_t i = 1; i <= kChanges; ++i) {
+    times.push_back(Press(i & 1));
+    PollFor(ButtonScanner::DEBOUNCE_MS + 1);
+  }
+
+  std::vector<ButtonEvent> events = Events();
+  ASSERT_EQ(events.size(), ButtonScanner::MAX_EVENTS);
+  // The first 4 changes were dropped, the newest is last
+  EXPECT_EQ(events.front().time_ms, times[4]);
+  EXPECT_EQ(events.back().time_ms, times.back());
+  EXPECT_EQ(events.back().state, kChanges & 1);
+}
+
+}  // namespace
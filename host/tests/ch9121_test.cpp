@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include "ch9120.h"
+#include "fake_ch9121.h"
+#include "host_test.h"
+
+namespace {
+
+constexpr uint8_t kRstPin = 19;
+constexpr uint8_t kCfgPin = 18;
+
+const CH9121Config kConfig = {
+    .gateway = {192, 168, 0, 1},
+    .subnet_mask = {255, 255, 255, 0},
+    .local_ip = {192, 168, 0, 51},
+    .target_ip = {192, 168, 0, 1},
+    .local_port = 51333,
+    .target_port = 51334,
+    .baud_rate = 921600,
+    .mode = 0x00,
+};
+
+class Ch9121Test : public HostTest {
+ protected:
+  // Store kConfig in the fake module, as if configured on an earlier boot
+  void StoreConfig() {
+    module_.setting(0x60) = {kConfig.mode};
+    module_.setting(0x61).assign(kConfig.local_ip, kConfig.local_ip + 4);
+    module_.setting(0x62).assign(kConfig.subnet_mask,
+                                 kConfig.subnet_mask + 4);
+    module_.setting(0x63).assign(kConfig.gateway, kConfig.gateway + 4);
+    module_.setting(0x64) = {0x85, 0xC8};  // 51333
+    module_.setting(0x65).assign(kConfig.target_ip, kConfig.target_ip + 4);
+    module_.setting(0x66) = {0x86, 0xC8};  // 51334
+    module_.setting(0x71) = {0x00, 0x10, 0x0E, 0x00};  // 921600
+  }
+
+  // Step a configuration to the end with 1 ms loop() passes. Returns the
+  // time it took in ms.
+  uint32_t RunConfiguration() {
+    uint32_t start = millis();
+    ch9121_.Begin();
+    ch9121_.StartConfigure();
+    while (ch9121_.Step()) host_clock::advance_ms(1);
+    return millis() - start;
+  }
+
+  FakeCh9121 module_{Serial2, kCfgPin};
+  CH9121 ch9121_{&Serial2, kConfig, kRstPin, kCfgPin};
+};
+
+TEST_F(Ch9121Test, WritesAndSavesEveryDifferingField) {
+  RunConfiguration();
+
+  EXPECT_TRUE(ch9121_.Responded());
+  EXPECT_EQ(ch9121_.FieldsWritten(), 7);  // The stored mode already matches
+  EXPECT_EQ(module_.writes(), 7);
+  EXPECT_EQ(module_.saves(), 1);
+  EXPECT_EQ(digitalRead(kCfgPin), HIGH);
+  EXPECT_EQ(Serial2.baud(), kConfig.baud_rate);
+}
+
+TEST_F(Ch9121Test, LeavesAMatchingModuleAlone) {
+  StoreConfig();
+  RunConfiguration();
+
+  EXPECT_EQ(ch9121_.FieldsWritten(), 0);
+  EXPECT_EQ(module_.writes(), 0);
+  EXPECT_EQ(module_.saves(), 0);
+}
+
+TEST_F(Ch9121Test, WritesOnlyTheChangedTargetOnReconfigure) {
+  StoreConfig();
+  RunConfiguration();
+
+  const uint8_t target_ip[4] = {192, 168, 0, 7};
+  ch9121_.Reconfigure(target_ip, 50000);
+  while (ch9121_.Step()) host_clock::advance_ms(1);
+
+  EXPECT_EQ(ch9121_.FieldsWritten(), 2);
+  EXPECT_EQ(module_.setting(0x65), std::vector<uint8_t>({192, 168, 0, 7}));
+  EXPECT_EQ(module_.setting(0x66), std::vector<uint8_t>({0x50, 0xC3}));
+  EXPECT_EQ(module_.saves(), 1);
+}
+
+TEST_F(Ch9121Test, WritesEverythingIfTheModuleNeverAnswers) {
+  module_.ready_ms = 100000;
+  RunConfiguration();
+
+  EXPECT_FALSE(ch9121_.Responded());
+  EXPECT_EQ(ch9121_.FieldsWritten(), 8);
+}
+
+TEST_F(Ch9121Test, WaitsForReceivedDataBeforeEnteringConfigMode) {
+  Serial2.inject("led:");
+  ch9121_.StartConfigure();
+
+  EXPECT_TRUE(ch9121_.Step());
+  EXPECT_FALSE(ch9121_.InConfigMode());
+
+  Serial2.take_output();
+  while (Serial2.available()) Serial2.read();
+  EXPECT_TRUE(ch9121_.Step());
+  EXPECT_TRUE(ch9121_.InConfigMode());
+}
+
+TEST_F(Ch9121Test, EntersConfigModeAfterATimeoutIfDataKeepsArriving) {
+  ch9121_.StartConfigure();
+  uint32_t start = millis();
+  do {
+    // A host streaming faster than loop() reads
+    Serial2.inject("led:AAAA\n");
+    host_clock::advance_ms(1);
+    ch9121_.Step();
+  } while (!ch9121_.InConfigMode() && millis() - start < 2000);
+
+  EXPECT_TRUE(ch9121_.InConfigMode());
+  EXPECT_GE(millis() - start, CH9121::PENDING_TIMEOUT_MS);
+  EXPECT_LE(millis() - start, CH9121::PENDING_TIMEOUT_MS + 1);
+}
+
+// Boot-to-ready time of the blocking Configure() in setup(), with the module
+// answering 200 ms after entering configuration mode and 2 ms after each
+// command. The fixed delays this replaced added up to 3 s per boot.
+TEST_F(Ch9121Test, BootTimeWithStoredSettingsMatching) {
+  StoreConfig();
+  host_clock::set_tick_us(10);
+  uint32_t start = millis();
+  ch9121_.Begin();
+  int written = ch9121_.Configure();
+  uint32_t boot_ms = millis() - start;
+
+  RecordProperty("boot_ms", boot_ms);
+  EXPECT_EQ(written, 0);
+  EXPECT_LT(boot_ms, 350u);
+}
+
+TEST_F(Ch9121Test, BootTimeWithAllSettingsChanged) {
+  host_clock::set_tick_us(10);
+  uint32_t start = millis();
+  ch9121_.Begin();
+  int written = ch9121_.Configure();
+  uint32_t boot_ms = millis() - start;
+
+  RecordProperty("boot_ms", boot_ms);
+  EXPECT_EQ(written, 7);
+  EXPECT_LT(boot_ms, 400u);
+}
+
+}  // namespace
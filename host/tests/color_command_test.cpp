@@ -0,0 +1,74 @@
+#include "color_command.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "command.h"
+#include "host_test.h"
+
+namespace {
+
+class ColorCommandTest : public HostTest {
+ protected:
+  // Colour of one LED of in after the pipeline
+  CRGB Apply(CRGB in) {
+    CRGB out;
+    uint16_t map = 0;
+    pipeline_.apply(&out, &in, &map, 1);
+    return out;
+  }
+
+  ColorPipeline pipeline_;
+  ColorCommand color_{pipeline_};
+  Command* commands_[1] = {&color_};
+  CommandProcessor processor_{commands_, Serial};
+};
+
+TEST_F(ColorCommandTest, SetsEachSetting) {
+  processor_.process_chars("color:gamma:2.2\n");
+  EXPECT_FLOAT_EQ(pipeline_.settings().gamma, 2.2f);
+  processor_.process_chars("color:brightness:128\n");
+  EXPECT_EQ(pipeline_.settings().brightness, 128);
+  processor_.process_chars("color:balance:255:224:0\n");
+  EXPECT_EQ(pipeline_.settings().balance[1], 224);
+  EXPECT_EQ(pipeline_.version(), 3u);
+
+  // Gamma, then brightness, then balance: 128 for red and 112 for green
+  EXPECT_EQ(Apply(CRGB(255, 255, 255)), CRGB(128, 112, 0));
+  EXPECT_EQ(Apply(CRGB(128, 128, 128)).r, 28);  // 0.502^2.2 * 128
+}
+
+TEST_F(ColorCommandTest, ResetRemovesTheCorrection) {
+  processor_.process_chars("color:gamma:2.2\ncolor:brightness:10\n");
+  processor_.process_chars("color:reset\n");
+
+  EXPECT_FLOAT_EQ(pipeline_.settings().gamma, 1.0f);
+  EXPECT_EQ(pipeline_.settings().brightness, 255);
+  EXPECT_EQ(Apply(CRGB(1, 128, 255)), CRGB(1, 128, 255));
+}
+
+TEST_F(ColorCommandTest, RejectsInvalidSettings) {
+  processor_.process_chars("color:brightness:100\n");
+  const char* invalid[] = {
+      "color:gamma:0",         "color:gamma:5.5",
+      "color:gamma:2.2x",      "color:gamma:",
+      "color:brightness:256",  "color:brightness:1:2",
+      "color:brightness:-1",   "color:balance:1:2",
+      "color:balance:1:2:3:4", "color:balance:1:x:3",
+      "color:reset:1",         "color:contrast:2",
+      "color",
+  };
+  for (const char* line : invalid) {
+    Serial.take_output();
+    processor_.process_chars(std::string(line) + "\n");
+    EXPECT_EQ(Serial.take_output(), "Invalid color command format\r\n")
+        << line;
+  }
+
+  EXPECT_EQ(pipeline_.version(), 1u);
+  EXPECT_EQ(pipeline_.settings().brightness, 100);
+  EXPECT_FLOAT_EQ(pipeline_.settings().gamma, 1.0f);
+}
+
+}  // namespace
@@ -0,0 +1,183 @@
+#include "command.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "host_test.h"
+
+namespace {
+
+// Records what the processor hands it
+class RecordingCommand : public Command {
+ public:
+  explicit RecordingCommand(std::string_view prefix, bool streaming = false,
+                            FrameType frame_type = kFrameNone)
+      : Command(prefix, streaming, frame_type) {}
+
+  void process(std::string_view args) override {
+    lines.emplace_back(args);
+  }
+
+  void begin_stream() override { chunks.emplace_back(); }
+  void stream(std::string_view chunk) override { chunks.back() += chunk; }
+  void end_stream() override { ++streams_ended; }
+
+  void begin_frame(size_t length) override {
+    frame_length = length;
+    frame.clear();
+  }
+  void frame_data(std::span<const uint8_t> data) override {
+    frame.append(reinterpret_cast<const char*>(data.data()), data.size());
+  }
+  void end_frame(bool valid) override { frames.push_back(valid); }
+
+  std::vector<std::string> lines;
+  std::vector<std::string> chunks;
+  int streams_ended = 0;
+  size_t frame_length = 0;
+  std::string frame;
+  std::vector<bool> frames;
+};
+
+class CommandProcessorTest : public HostTest {
+ protected:
+  RecordingCommand led_{"led", /*streaming=*/true, kFrameLed};
+  RecordingCommand ledseq_{"ledseq", /*streaming=*/false, kFrameLedSeq};
+  RecordingCommand lcd_{"lcd"};
+  RecordingCommand config_{"?"};
+  Command* commands_[4] = {&led_, &ledseq_, &lcd_, &config_};
+  CommandProcessor processor_{commands_, Serial};
+};
+
+TEST_F(CommandProcessorTest, DispatchesLinesByPrefix) {
+  processor_.process_chars("lcd:0:1:hi\n?\nledseq:7\n");
+
+  EXPECT_EQ(lcd_.lines, std::vector<std::string>{"0:1:hi"});
+  EXPECT_EQ(config_.lines, std::vector<std::string>{""});
+  EXPECT_EQ(ledseq_.lines, std::vector<std::string>{"7"});
+  EXPECT_EQ(processor_.unknown_commands(), 0u);
+}
+
+TEST_F(CommandProcessorTest, PrefixMustEndAtAWordBoundary) {
+  processor_.process_chars("lcdx:1\nfoo\n\n");
+
+  EXPECT_TRUE(lcd_.lines.empty());
+  EXPECT_EQ(processor_.unknown_commands(), 3u);
+  EXPECT_NE(Serial.output().find("Unknown command: lcdx:1\n"),
+            std::string::npos);
+}
+
+TEST_F(CommandProcessorTest, StreamsArgumentsOfStreamingCommands) {
+  processor_.process_chars("led:abc");
+  processor_.process_chars("def");
+  processor_.process_char('g');
+  EXPECT_EQ(led_.streams_ended, 0);
+  processor_.process_chars("\nlcd:x\n");
+
+  EXPECT_EQ(led_.chunks, std::vector<std::string>{"abcdefg"});
+  EXPECT_EQ(led_.streams_ended, 1);
+  EXPECT_EQ(lcd_.lines, std::vector<std::string>{"x"});
+}
+
+TEST_F(CommandProcessorTest, CountsTruncatedLines) {
+  processor_.process_chars("lcd:" + std::string(300, 'x') + "\n");
+
+  EXPECT_EQ(processor_.lines_truncated(), 1u);
+  ASSERT_EQ(lcd_.lines.size(), 1u);
+  EXPECT_EQ(lcd_.lines[0].size(), 256u - 4);
+}
+
+TEST_F(CommandProcessorTest, RoutesBinaryFramesByType) {
+  processor_.process_chars(BinaryFrame(kFrameLed, "abc") + "?\n" +
+                           BinaryFrame(kFrameLedSeq, ""));
+
+  EXPECT_EQ(led_.frame_length, 3u);
+  EXPECT_EQ(led_.frame, "abc");
+  EXPECT_EQ(led_.frames, std::vector<bool>{true});
+  EXPECT_EQ(ledseq_.frames, std::vector<bool>{true});
+  EXPECT_EQ(config_.lines.size(), 1u);
+}
+
+TEST_F(CommandProcessorTest, ReportsCrcErrors) {
+  std::string frame = BinaryFrame(kFrameLed, "abc");
+  frame[5] ^= 1;
+  processor_.process_chars(frame + "?\n");
+
+  EXPECT_EQ(led_.frames, std::vector<bool>{false});
+  EXPECT_EQ(processor_.frame_crc_errors(), 1u);
+  EXPECT_EQ(config_.lines.size(), 1u);
+}
+
+TEST_F(CommandProcessorTest, SkipsFramesOfUnknownType) {
+  processor_.process_chars(BinaryFrame(0x7F, "led:x\n") + "?\n");
+
+  EXPECT_TRUE(led_.chunks.empty());
+  EXPECT_EQ(config_.lines.size(), 1u);
+}
+
+TEST_F(CommandProcessorTest, AbandonsStalledFrames) {
+  std::string frame = BinaryFrame(kFrameLed, std::string(1000, 'x'));
+  processor_.process_chars(frame.substr(0, 100));
+
+  // The host reconnects and starts over
+  host_clock::advance_us(CommandProcessor::FRAME_TIMEOUT_US + 1);
+  processor_.process_chars("?\n" + frame);
+
+  EXPECT_EQ(processor_.frame_timeouts(), 1u);
+  EXPECT_EQ(config_.lines.size(), 1u);
+  EXPECT_EQ(led_.frames, std::vector<bool>({false, true}));
+  EXPECT_EQ(led_.frame, std::string(1000, 'x'));
+}
+
+TEST_F(CommandProcessorTest, SlowFramesWithinTheTimeoutComplete) {
+  std::string frame = BinaryFrame(kFrameLed, "abcdef");
+  for (char c : frame) {
+    host_clock::advance_us(CommandProcessor::FRAME_TIMEOUT_US / 2);
+    processor_.process_char(c);
+  }
+
+  EXPECT_EQ(processor_.frame_timeouts(), 0u);
+  EXPECT_EQ(led_.frames, std::vector<bool>{true});
+}
+
+// The first-byte table can be built at compile time from the prefixes alone
+constexpr std::string_view kPrefixes[] = {"led", "?", "lcd", "ledseq", ""};
+constexpr CommandTable kTable = BuildCommandTable(kPrefixes);
+static_assert(kTable.first['l'] == 0);
+static_assert(kTable.next[0] == 2);  // Registration order within a chain
+static_assert(kTable.next[2] == 3);
+static_assert(kTable.next[3] == CommandTable::kNoCommand);
+static_assert(kTable.first['?'] == 1);
+static_assert(kTable.first['x'] == CommandTable::kNoCommand);
+
+TEST_F(CommandProcessorTest, FirstRegisteredPrefixWins) {
+  RecordingCommand first{"fx"};
+  RecordingCommand second{"fx"};
+  Command* commands[] = {&first, &second};
+  CommandProcessor processor(commands, Serial);
+  processor.process_chars("fx:hue\n");
+
+  EXPECT_EQ(first.lines, std::vector<std::string>{"hue"});
+  EXPECT_TRUE(second.lines.empty());
+}
+
+TEST_F(CommandProcessorTest, IgnoresCommandsPastTheLimit) {
+  std::vector<RecordingCommand> recorders;
+  recorders.reserve(CommandTable::kMaxCommands + 1);
+  std::vector<Command*> commands;
+  for (size_t i = 0; i <= CommandTable::kMaxCommands; ++i) {
+    commands.push_back(&recorders.emplace_back("c"));
+  }
+  commands.front() = &lcd_;
+  commands.back() = &config_;
+  CommandProcessor processor(commands, Serial);
+  processor.process_chars("lcd:1\n?\n");
+
+  EXPECT_EQ(lcd_.lines, std::vector<std::string>{"1"});
+  EXPECT_TRUE(config_.lines.empty());
+  EXPECT_EQ(processor.unknown_commands(), 1u);
+}
+
+}  // namespace
@@ -0,0 +1,32 @@
+#include "config_command.h"
+
+#include <gtest/gtest.h>
+
+#include "command.h"
+#include "host_test.h"
+
+namespace {
+
+constexpr size_t kNumLeds = 64;
+
+class ConfigCommandTest : public HostTest {
+ protected:
+  uint16_t maps_[3 * kNumLeds];
+  Geometry geometry_{maps_, kNumLeds};
+  TxQueue tx_{&Serial2};
+  ConfigCommand config_{geometry_, 4, tx_};
+  Command* commands_[1] = {&config_};
+  CommandProcessor processor_{commands_, Serial};
+};
+
+// The host reads replies a line at a time, so each must end its line
+TEST_F(ConfigCommandTest, RepliesWithALine) {
+  processor_.process_chars("?\n?\n");
+  tx_.service();
+
+  const char* reply =
+      "{\"geom\": \"linear\", \"num_leds\": 64, \"lanes\": 4}\r\n";
+  EXPECT_EQ(Serial2.take_output(), std::string(reply) + reply);
+}
+
+}  // namespace
@@ -0,0 +1,149 @@
+#include "effect_engine.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "command.h"
+#include "firmware_stats.h"
+#include "host_test.h"
+#include "led_command.h"
+#include "sequenced_led_command.h"
+
+namespace {
+
+constexpr size_t kNumLeds = 1024;
+
+class EffectEngineTest : public HostTest {
+ protected:
+  // Render the effect elapsed_ms after it started
+  void RenderAt(uint32_t elapsed_ms) {
+    host_clock::advance_ms(elapsed_ms);
+    engine_.render(millis());
+  }
+
+  CRGB leds_[kNumLeds] = {};
+  CRGB from_[kNumLeds];
+  CRGB target_[kNumLeds];
+  CRGB storage_[3 * kNumLeds];
+  FrameSlot slot_{storage_, kNumLeds};
+  EffectEngine engine_{leds_, from_, target_, kNumLeds, slot_};
+};
+
+TEST_F(EffectEngineTest, ChaseWrapsAroundTheEnd) {
+  engine_.chase(CRGB::Red, kNumLeds, 3);
+  RenderAt(1);
+
+  EXPECT_EQ(leds_[1], CRGB(CRGB::Red));
+  EXPECT_EQ(leds_[0], CRGB(CRGB::Red));
+  EXPECT_EQ(leds_[kNumLeds - 1], CRGB(CRGB::Red));
+  EXPECT_EQ(leds_[2], CRGB(CRGB::Black));
+  EXPECT_EQ(leds_[kNumLeds - 2], CRGB(CRGB::Black));
+}
+
+// Periods and durations long enough for the position arithmetic to exceed
+// 32 bits; each effect is halfway or a quarter through. The chase only
+// overflowed where size_t is 32 bits, as on the RP2040.
+
+TEST_F(EffectEngineTest, ChaseWithALongPeriod) {
+  engine_.chase(CRGB::Red, 10000000, 1);
+  RenderAt(5000000);
+
+  EXPECT_EQ(leds_[kNumLeds / 2], CRGB(CRGB::Red));
+  EXPECT_EQ(leds_[kNumLeds / 2 - 1], CRGB(CRGB::Black));
+}
+
+TEST_F(EffectEngineTest, HueWithALongPeriod) {
+  engine_.hue(100000000, 0, 255);
+  RenderAt(25000000);
+
+  EXPECT_EQ(leds_[0], CRGB(CHSV(64, 255, 255)));
+}
+
+TEST_F(EffectEngineTest, TransitionWithALongDuration) {
+  engine_.capture();
+  fill_solid(leds_, kNumLeds, CRGB::White);
+  engine_.transition(100000000, EffectEngine::kLinear);
+  RenderAt(50000000);
+
+  EXPECT_EQ(leds_[0], CRGB(128, 128, 128));
+  EXPECT_TRUE(engine_.running());
+}
+
+TEST_F(EffectEngineTest, RestoreResumesTheStoppedEffect) {
+  engine_.chase(CRGB::Red, kNumLeds, 1);
+  RenderAt(10);
+  engine_.capture();
+  fill_solid(leds_, kNumLeds, CRGB::Blue);  // A keyframe that was dropped
+  engine_.restore();
+
+  EXPECT_TRUE(engine_.running());
+  RenderAt(10);
+  EXPECT_EQ(leds_[20], CRGB(CRGB::Red));
+  EXPECT_EQ(leds_[0], CRGB(CRGB::Black));
+}
+
+TEST_F(EffectEngineTest, RestoreResumesAnInterruptedTransition) {
+  engine_.capture();
+  fill_solid(leds_, kNumLeds, CRGB::White);
+  engine_.transition(1000, EffectEngine::kLinear);
+  RenderAt(500);
+  ASSERT_EQ(leds_[0], CRGB(128, 128, 128));
+
+  engine_.capture();
+  fill_solid(leds_, kNumLeds, CRGB::Blue);
+  host_clock::advance_ms(100);  // The keyframe arriving
+  engine_.restore();
+
+  EXPECT_EQ(leds_[0], CRGB(128, 128, 128));
+  RenderAt(150);  // 750 ms into the transition, where it would be at 191
+  EXPECT_NEAR(leds_[0].r, 191, 1);
+  RenderAt(250);
+  EXPECT_EQ(leds_[0], CRGB(CRGB::White));
+  EXPECT_FALSE(engine_.running());
+}
+
+// LED frames sent during a transition, through the commands the sketch wires
+// to the engine
+class EffectEngineFrameTest : public EffectEngineTest {
+ protected:
+  EffectEngineFrameTest() {
+    led_.set_engine(&engine_);
+    engine_.capture();
+    fill_solid(leds_, kNumLeds, CRGB::White);
+    engine_.transition(1000, EffectEngine::kLinear);
+    RenderAt(500);
+  }
+
+  FirmwareStats stats_;
+  LedCommand led_{leds_, kNumLeds, slot_};
+  SequencedLedCommand sequenced_{led_, stats_};
+  Command* commands_[2] = {&led_, &sequenced_};
+  CommandProcessor processor_{commands_, Serial};
+};
+
+TEST_F(EffectEngineFrameTest, PlainFrameCancelsTheTransition) {
+  // A patch made against the keyframe, the last frame the host sent
+  std::string patch = {char(0xFF), char(0xFF), LedCommand::OP_SET, 0, 0, 1,
+                       1,          2,          3};
+  processor_.process_chars(BinaryFrame(kFrameLed, patch));
+
+  EXPECT_FALSE(engine_.running());
+  EXPECT_EQ(leds_[0], CRGB(1, 2, 3));
+  EXPECT_EQ(leds_[1], CRGB(CRGB::White));
+  RenderAt(100);
+  EXPECT_EQ(leds_[0], CRGB(1, 2, 3));
+}
+
+TEST_F(EffectEngineFrameTest, SequencedFrameCancelsTheTransition) {
+  std::vector<CRGB> leds(kNumLeds, CRGB::Blue);
+  std::string seq = {1, 0};
+  processor_.process_chars(BinaryFrame(kFrameLedSeq, seq + LedPayload(leds)));
+
+  EXPECT_FALSE(engine_.running());
+  RenderAt(600);
+  EXPECT_EQ(std::vector<CRGB>(leds_, leds_ + kNumLeds), leds);
+}
+
+}  // namespace
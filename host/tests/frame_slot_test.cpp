@@ -0,0 +1,88 @@
+#include "frame_slot.h"
+
+#include <gtest/gtest.h>
+
+#include "command.h"
+#include "host_test.h"
+#include "rate_command.h"
+
+namespace {
+
+constexpr size_t kNumLeds = 4;
+
+class FrameSlotTest : public HostTest {
+ protected:
+  // Publish a frame whose LEDs are all set to red level n
+  void Publish(uint8_t n) {
+    fill_solid(frame_, kNumLeds, CRGB(n, 0, 0));
+    slot_.publish(frame_);
+  }
+
+  CRGB frame_[kNumLeds];
+  CRGB storage_[3 * kNumLeds];
+  FrameSlot slot_{storage_, kNumLeds};
+  RateCommand rate_{slot_};
+  Command* commands_[1] = {&rate_};
+  CommandProcessor processor_{commands_, Serial};
+};
+
+TEST_F(FrameSlotTest, ShowsEveryFrameWithoutALimit) {
+  for (uint8_t n = 1; n <= 10; ++n) {
+    Publish(n);
+    host_clock::advance_us(100);
+    ASSERT_TRUE(slot_.take(micros()));
+    EXPECT_EQ(slot_.front()[0].r, n);
+  }
+  EXPECT_FALSE(slot_.take(micros()));
+
+  EXPECT_EQ(slot_.published(), 10u);
+  EXPECT_EQ(slot_.presented(), 10u);
+  EXPECT_EQ(slot_.dropped(), 0u);
+}
+
+TEST_F(FrameSlotTest, LatestFrameWinsAboveTheRate) {
+  processor_.process_chars("rate:50\n");
+
+  // 200 frames/s for a second, with core 1 polling every millisecond
+  uint8_t last = 0;
+  for (int ms = 1; ms <= 1000; ++ms) {
+    host_clock::advance_ms(1);
+    if (ms % 5 == 0) Publish(++last);
+    if (slot_.take(micros())) {
+      EXPECT_EQ(slot_.front()[0].r, last);
+      EXPECT_EQ(slot_.front()[kNumLeds - 1].r, last);
+    }
+  }
+
+  EXPECT_EQ(slot_.published(), 200u);
+  EXPECT_NEAR(slot_.presented(), 50, 1);
+  // Every frame is either shown, replaced unshown, or still waiting
+  uint32_t waiting = slot_.take(micros() + 20000) ? 1 : 0;
+  EXPECT_EQ(slot_.presented() - waiting + slot_.dropped(), 200u);
+}
+
+TEST_F(FrameSlotTest, RateZeroRemovesTheLimit) {
+  processor_.process_chars("rate:10\nrate:0\n");
+  Publish(1);
+  EXPECT_TRUE(slot_.take(micros()));
+  Publish(2);
+  EXPECT_TRUE(slot_.take(micros()));
+}
+
+TEST_F(FrameSlotTest, InvalidRateKeepsTheLimit) {
+  processor_.process_chars("rate:10\nrate:fast\n");
+  EXPECT_NE(Serial.output().find("Invalid rate command format"),
+            std::string::npos);
+
+  host_clock::advance_ms(200);
+  Publish(1);
+  EXPECT_TRUE(slot_.take(micros()));
+  host_clock::advance_ms(50);
+  Publish(2);
+  EXPECT_FALSE(slot_.take(micros()));
+  host_clock::advance_ms(50);
+  EXPECT_TRUE(slot_.take(micros()));
+  EXPECT_EQ(slot_.front()[0].r, 2);
+}
+
+}  // namespace
@@ -0,0 +1,118 @@
+#include "geometry.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "color_pipeline.h"
+#include "command.h"
+#include "geom_command.h"
+#include "host_test.h"
+#include "led_lanes.h"
+
+namespace {
+
+constexpr size_t kNumLeds = 30;  // A 3*3*3 cube and 3 LEDs past it
+
+class GeometryTest : public HostTest {
+ protected:
+  const uint16_t* Map() {
+    uint32_t version;
+    return geometry_.acquire(version);
+  }
+
+  std::string Json() {
+    Serial.take_output();
+    geometry_.print_json(Serial);
+    return Serial.take_output();
+  }
+
+  uint16_t maps_[3 * kNumLeds];
+  Geometry geometry_{maps_, kNumLeds};
+  GeomCommand geom_{geometry_};
+  Command* commands_[1] = {&geom_};
+  CommandProcessor processor_{commands_, Serial};
+};
+
+TEST_F(GeometryTest, SerpentineCubeReversesEveryOtherRow) {
+  ASSERT_TRUE(geometry_.set_cube(3, /*serpentine=*/true));
+  const uint16_t* map = Map();
+
+  // Rows of 3 along x, y then z, so row 3 is the first of layer 1
+  const uint16_t expected[kNumLeds] = {
+      0,  1,  2,  5,  4,  3,  6,  7,  8,   // Layer 0
+      11, 10, 9,  12, 13, 14, 17, 16, 15,  // Layer 1
+      18, 19, 20, 23, 22, 21, 24, 25, 26,  // Layer 2
+      27, 28, 29,                          // Past the cube
+  };
+  EXPECT_EQ(std::vector<uint16_t>(map, map + kNumLeds),
+            std::vector<uint16_t>(expected, expected + kNumLeds));
+}
+
+TEST_F(GeometryTest, CubeMustFitTheStrip) {
+  uint32_t version = geometry_.version();
+  EXPECT_FALSE(geometry_.set_cube(4, false));
+  EXPECT_FALSE(geometry_.set_cube(0, false));
+  EXPECT_EQ(geometry_.version(), version);
+  EXPECT_EQ(Json(), "\"geom\": \"linear\"");
+}
+
+TEST_F(GeometryTest, GeomCommandSetsTheLayout) {
+  processor_.process_chars("geom:cube:3:serpentine\n");
+  EXPECT_EQ(Json(), "\"geom\": \"cube\", \"size\": 3, \"serpentine\": true");
+  EXPECT_EQ(Map()[3], 5);
+
+  processor_.process_chars("geom:cube:2\n");
+  EXPECT_EQ(Json(), "\"geom\": \"cube\", \"size\": 2, \"serpentine\": false");
+  EXPECT_EQ(Map()[3], 3);
+
+  processor_.process_chars("geom:linear\n");
+  EXPECT_EQ(Json(), "\"geom\": \"linear\"");
+}
+
+TEST_F(GeometryTest, GeomCommandRejectsInvalidLayouts) {
+  processor_.process_chars("geom:cube:3\n");
+  uint32_t version = geometry_.version();
+  const char* invalid[] = {
+      "geom:cube",          "geom:cube:",   "geom:cube:x",
+      "geom:cube:3:zigzag", "geom:sphere:3", "geom",
+  };
+  for (const char* line : invalid) {
+    Serial.take_output();
+    processor_.process_chars(std::string(line) + "\n");
+    EXPECT_EQ(Serial.take_output(), "Invalid geom command format\r\n")
+        << line;
+  }
+
+  processor_.process_chars("geom:cube:4\n");
+  EXPECT_EQ(Serial.take_output(), "Cube does not fit the LED strip\r\n");
+  EXPECT_EQ(geometry_.version(), version);
+}
+
+// Core 1's path with three lanes instead of the board's one: the frame is
+// remapped into the strip buffer, which the lanes show a third each
+TEST_F(GeometryTest, LanesShowTheRemappedFrame) {
+  CRGB leds[kNumLeds];
+  LedLanes<25, 26, 27>::add(leds, kNumLeds);
+  ASSERT_EQ(FastLED.controllers().size(), 3u);
+
+  geometry_.set_cube(3, /*serpentine=*/true);
+  CRGB frame[kNumLeds];
+  for (size_t i = 0; i < kNumLeds; ++i) frame[i] = CRGB(i, 0, 0);
+  ColorPipeline pipeline;
+  pipeline.apply(leds, frame, Map(), kNumLeds);
+  FastLED.show();
+
+  // Lane 1 is strip positions 10-19, from the middle of reversed row 3
+  const CLEDController& lane = FastLED.controllers()[1];
+  EXPECT_EQ(lane.pin(), 26);
+  ASSERT_EQ(lane.size(), 10);
+  std::vector<uint8_t> shown;
+  for (const CRGB& led : lane.shown()) shown.push_back(led.r);
+  EXPECT_EQ(shown, std::vector<uint8_t>({10, 9, 12, 13, 14, 17, 16, 15, 18,
+                                         19}));
+  EXPECT_EQ(FastLED.controllers()[2].shown().back().r, 29);
+}
+
+}  // namespace
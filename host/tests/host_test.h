@@ -0,0 +1,12 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "host_support.h"
+
+// Base fixture that resets the host clock, buses and ports before the test's
+// members are constructed, so fakes can attach to them
+class HostTest : public ::testing::Test {
+ protected:
+  HostTest() { ResetHost(); }
+};
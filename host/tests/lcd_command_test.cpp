@@ -0,0 +1,69 @@
+#include "lcd_command.h"
+
+#include <LiquidCrystal_PCF8574.h>
+#include <gtest/gtest.h>
+
+#include "host_test.h"
+#include "lcd_framebuffer.h"
+
+namespace {
+
+bool cleared = false;
+
+class LcdCommandTest : public HostTest {
+ protected:
+  void SetUp() override {
+    lcd_.begin(20, 4);
+    cleared = false;
+  }
+
+  LiquidCrystal_PCF8574 lcd_{0x27};
+  LcdFramebuffer framebuffer_{lcd_, 20, 4};
+  LcdCommand command_{framebuffer_};
+};
+
+TEST_F(LcdCommandTest, WritesTextAtPosition) {
+  command_.process("3:1:Hello");
+  command_.process("0:3:x");
+  framebuffer_.flush(100000);
+
+  EXPECT_EQ(lcd_.row(1), "   Hello            ");
+  EXPECT_EQ(lcd_.row(3), "x                   ");
+}
+
+TEST_F(LcdCommandTest, IgnoresPositionsOffTheDisplay) {
+  command_.process("20:0:x");
+  command_.process("0:4:x");
+  command_.process("a:0:x");
+  command_.process("0:0");
+  framebuffer_.flush(100000);
+
+  for (uint8_t row = 0; row < 4; ++row) {
+    EXPECT_EQ(lcd_.row(row), std::string(20, ' '));
+  }
+}
+
+TEST_F(LcdCommandTest, OnlyChangedCellsGoOverI2c) {
+  command_.process("0:0:Status 1");
+  framebuffer_.flush(100000);
+  uint64_t characters = lcd_.characters();
+
+  command_.process("0:0:Status 2");
+  framebuffer_.flush(100000);
+
+  EXPECT_EQ(lcd_.characters() - characters, 1u);
+  EXPECT_EQ(lcd_.row(0).substr(0, 8), "Status 2");
+}
+
+TEST_F(LcdCommandTest, ClearEmptiesTheDisplayAndCallsOnClear) {
+  command_.on_clear = []() { cleared = true; };
+  command_.process("0:0:abc");
+  framebuffer_.flush(100000);
+  command_.process("clear");
+  framebuffer_.flush(100000);
+
+  EXPECT_TRUE(cleared);
+  EXPECT_EQ(lcd_.row(0), std::string(20, ' '));
+}
+
+}  // namespace
@@ -0,0 +1,233 @@
+#include "led_command.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "command.h"
+#include "effect_engine.h"
+#include "host_test.h"
+
+namespace {
+
+constexpr size_t kNumLeds = 8;
+
+class LedCommandTest : public HostTest {
+ protected:
+  // Frame shown after taking the latest one from the slot, or empty
+  std::vector<CRGB> Shown() {
+    if (!slot_.take(micros())) return {};
+    return std::vector<CRGB>(slot_.front(), slot_.front() + kNumLeds);
+  }
+
+  CRGB frame_[kNumLeds] = {};
+  CRGB storage_[3 * kNumLeds];
+  FrameSlot slot_{storage_, kNumLeds};
+  LedCommand led_{frame_, kNumLeds, slot_};
+  Command* commands_[1] = {&led_};
+  CommandProcessor processor_{commands_, Serial};
+};
+
+TEST_F(LedCommandTest, DecodesBase64Frames) {
+  std::vector<CRGB> leds = TestPattern(kNumLeds);
+  processor_.process_chars("led:" + Base64Encode(LedPayload(leds)) + "\n");
+
+  EXPECT_EQ(Shown(), leds);
+}
+
+TEST_F(LedCommandTest, DecodesBinaryFrames) {
+  std::vector<CRGB> leds = TestPattern(kNumLeds, 40);
+  processor_.process_chars(BinaryFrame(kFrameLed, LedPayload(leds)));
+
+  EXPECT_EQ(Shown(), leds);
+}
+
+TEST(LedCommandStreamingTest, DecodesLongFramesOneCharacterAtATime) {
+  ResetHost();
+  constexpr size_t kLongStrip = 1000;
+  std::vector<CRGB> frame(kLongStrip);
+  std::vector<CRGB> storage(3 * kLongStrip);
+  FrameSlot slot(storage.data(), kLongStrip);
+  LedCommand led(frame.data(), kLongStrip, slot);
+  Command* commands[] = {&led};
+  CommandProcessor processor(commands, Serial);
+
+  // About 4 kB of base64, far more than the 256-byte line buffer
+  std::vector<CRGB> leds = TestPattern(kLongStrip);
+  std::string line = "led:" + Base64Encode(LedPayload(leds)) + "\n";
+  for (char c : line) processor.process_char(c);
+
+  EXPECT_EQ(processor.lines_truncated(), 0u);
+  ASSERT_TRUE(slot.take(0));
+  EXPECT_EQ(std::vector<CRGB>(slot.front(), slot.front() + kLongStrip), leds);
+}
+
+TEST_F(LedCommandTest, ShortFramesLeaveTheRestAndLongFramesAreClipped) {
+  std::vector<CRGB> first = TestPattern(kNumLeds);
+  processor_.process_chars(BinaryFrame(kFrameLed, LedPayload(first)));
+  Shown();
+
+  std::vector<CRGB> second = TestPattern(2, 100);
+  processor_.process_chars(BinaryFrame(kFrameLed, LedPayload(second)));
+  std::vector<CRGB> expected = first;
+  expected[0] = second[0];
+  expected[1] = second[1];
+  EXPECT_EQ(Shown(), expected);
+
+  std::vector<CRGB> long_frame = TestPattern(kNumLeds + 5, 7);
+  processor_.process_chars(BinaryFrame(kFrameLed, LedPayload(long_frame)));
+  long_frame.resize(kNumLeds);
+  EXPECT_EQ(Shown(), long_frame);
+}
+
+TEST_F(LedCommandTest, DoesNotPublishInvalidFrames) {
+  processor_.process_chars("led:AQA*AAA\n");
+  EXPECT_TRUE(Shown().empty());
+
+  std::string frame = BinaryFrame(kFrameLed, LedPayload(TestPattern(2)));
+  frame[6] ^= 0xFF;
+  processor_.process_chars(frame);
+  EXPECT_TRUE(Shown().empty());
+  EXPECT_EQ(slot_.published(), 0u);
+}
+
+TEST_F(LedCommandTest, AppliesPatchRecords) {
+  processor_.process_chars(
+      BinaryFrame(kFrameLed, LedPayload(std::vector<CRGB>(kNumLeds))));
+  Shown();
+
+  // Fill 1-3 with grey, set 5 to red, then runs of 1 blue and 1 green from 6
+  std::string patch = {
+      char(0xFF), char(0xFF),                                    //
+      LedCommand::OP_FILL, 1, 0, 3, 0, 9, 9, 9,                  //
+      LedCommand::OP_PAD,                                        //
+      LedCommand::OP_SET, 5, 0, 1, char(200), 0, 0,              //
+      LedCommand::OP_RUNS, 6, 0, 2, 1, 0, 0, char(255), 1, 0, 7, 0,
+  };
+  processor_.process_chars(BinaryFrame(kFrameLed, patch));
+
+  std::vector<CRGB> expected(kNumLeds, CRGB(0, 0, 0));
+  expected[1] = expected[2] = expected[3] = CRGB(9, 9, 9);
+  expected[5] = CRGB(200, 0, 0);
+  expected[6] = CRGB(0, 0, 255);
+  expected[7] = CRGB(0, 7, 0);
+  EXPECT_EQ(Shown(), expected);
+}
+
+TEST_F(LedCommandTest, RejectsPatchesThatEndMidRecord) {
+  processor_.process_chars(
+      BinaryFrame(kFrameLed, LedPayload(std::vector<CRGB>(kNumLeds))));
+  Shown();
+
+  // OP_SET declaring 3 elements but carrying 1
+  std::string truncated = {char(0xFF), char(0xFF), LedCommand::OP_SET, 0, 0, 3,
+                           10,         10,         10};
+  processor_.process_chars(BinaryFrame(kFrameLed, truncated));
+  EXPECT_TRUE(Shown().empty());
+
+  // The next frame starts from a clean record state
+  std::string fill = {char(0xFF), char(0xFF), LedCommand::OP_FILL, 4, 0, 2, 0,
+                      7,          7,          7};
+  processor_.process_chars(BinaryFrame(kFrameLed, fill));
+  std::vector<CRGB> shown = Shown();
+  ASSERT_EQ(shown.size(), kNumLeds);
+  EXPECT_EQ(shown[3], CRGB(0, 0, 0));
+  EXPECT_EQ(shown[4], CRGB(7, 7, 7));
+  EXPECT_EQ(shown[5], CRGB(7, 7, 7));
+  EXPECT_EQ(shown[6], CRGB(0, 0, 0));
+}
+
+TEST_F(LedCommandTest, InvalidFramesLeaveTheLastGoodFrame) {
+  CRGB backup[kNumLeds];
+  led_.set_backup(backup);
+  std::vector<CRGB> good = TestPattern(kNumLeds);
+  processor_.process_chars(BinaryFrame(kFrameLed, LedPayload(good)));
+
+  std::string corrupt = BinaryFrame(kFrameLed, LedPayload(TestPattern(4, 9)));
+  corrupt.back() ^= 1;
+  processor_.process_chars(corrupt);
+  processor_.process_chars("led:AwAJCQkJCQkJ*\n");
+  EXPECT_EQ(std::vector<CRGB>(frame_, frame_ + kNumLeds), good);
+
+  // A patch after the bad frames applies to the good one
+  std::string patch = {char(0xFF), char(0xFF), LedCommand::OP_SET, 0, 0, 1,
+                       1,          2,          3};
+  processor_.process_chars(BinaryFrame(kFrameLed, patch));
+  good[0] = CRGB(1, 2, 3);
+  EXPECT_EQ(std::vector<CRGB>(frame_, frame_ + kNumLeds), good);
+}
+
+TEST_F(LedCommandTest, HeldFramesStayInTheBuffer) {
+  led_.set_hold(true);
+  std::vector<CRGB> leds = TestPattern(kNumLeds);
+  processor_.process_chars(BinaryFrame(kFrameLed, LedPayload(leds)));
+
+  EXPECT_TRUE(led_.held_frame_ok());
+  EXPECT_TRUE(Shown().empty());
+  EXPECT_EQ(std::vector<CRGB>(frame_, frame_ + kNumLeds), leds);
+}
+
+class LedCommandEffectTest : public LedCommandTest {
+ protected:
+  LedCommandEffectTest() {
+    led_.set_backup(backup_);
+    led_.set_engine(&engine_);
+    engine_.hue(1000, 256, 255);
+    engine_.render(millis());
+    Shown();
+  }
+
+  // Let the engine render between two loop() passes
+  void RenderLater() {
+    host_clock::advance_ms(20);
+    engine_.render(millis());
+  }
+
+  CRGB backup_[kNumLeds];
+  CRGB from_[kNumLeds];
+  CRGB target_[kNumLeds];
+  EffectEngine engine_{frame_, from_, target_, kNumLeds, slot_};
+};
+
+TEST_F(LedCommandEffectTest, BinaryFrameArrivingInChunksStopsTheEffect) {
+  std::vector<CRGB> leds(kNumLeds, CRGB::Blue);
+  std::string frame = BinaryFrame(kFrameLed, LedPayload(leds));
+  processor_.process_chars(frame.substr(0, 12));  // Header, count, 2 LEDs
+  RenderLater();
+  EXPECT_TRUE(Shown().empty());
+
+  processor_.process_chars(frame.substr(12));
+  EXPECT_EQ(Shown(), leds);
+  EXPECT_FALSE(engine_.running());
+  RenderLater();
+  EXPECT_TRUE(Shown().empty());
+}
+
+TEST_F(LedCommandEffectTest, TextFrameArrivingInChunksStopsTheEffect) {
+  std::vector<CRGB> leds(kNumLeds, CRGB::Blue);
+  std::string line = "led:" + Base64Encode(LedPayload(leds)) + "\n";
+  processor_.process_chars(line.substr(0, 16));
+  RenderLater();
+  EXPECT_TRUE(Shown().empty());
+
+  processor_.process_chars(line.substr(16));
+  EXPECT_EQ(Shown(), leds);
+  EXPECT_FALSE(engine_.running());
+}
+
+TEST_F(LedCommandEffectTest, InvalidFramesLeaveTheEffectRunning) {
+  std::string frame =
+      BinaryFrame(kFrameLed, LedPayload(std::vector<CRGB>(kNumLeds)));
+  frame.back() ^= 0xFF;
+  processor_.process_chars(frame.substr(0, 12));
+  RenderLater();
+  processor_.process_chars(frame.substr(12));
+
+  EXPECT_TRUE(engine_.running());
+  RenderLater();
+  std::vector<CRGB> shown = Shown();
+  ASSERT_EQ(shown.size(), kNumLeds);
+  EXPECT_EQ(shown[0], CRGB(CHSV(10, 255, 255)));
+}
+
+}  // namespace
@@ -0,0 +1,57 @@
+#include "pca9555.h"
+
+#include <Wire.h>
+#include <gtest/gtest.h>
+
+#include "fake_pca9555.h"
+#include "host_test.h"
+
+namespace {
+
+class Pca9555Test : public HostTest {
+ protected:
+  void SetUp() override {
+    Wire.attach(PCA9555::I2C_ADDR, &chip_);
+    pca_.begin();
+  }
+
+  FakePca9555 chip_;
+  PCA9555 pca_;
+};
+
+TEST_F(Pca9555Test, BeginConfiguresPinsAndTurnsLedsOff) {
+  EXPECT_EQ(chip_.config(0), 0b10101010);
+  EXPECT_EQ(chip_.config(1), 0b11111010);
+  EXPECT_EQ(chip_.output(0), 0);
+  EXPECT_EQ(chip_.output(1), 0);
+}
+
+TEST_F(Pca9555Test, ReadsActiveLowButtonsAndDip) {
+  // Buttons 0 and 5 pressed, DIP set to 0b1010
+  chip_.set_inputs(~((1 << 1) | (1 << 11)) & ~(0b0101 << 12));
+
+  EXPECT_EQ(pca_.readButtons(), 0b100001);
+  EXPECT_EQ(pca_.readDIP(), 0b1010);
+}
+
+TEST_F(Pca9555Test, MovesThePointerOffTheInputsAfterReading) {
+  pca_.readButtons();
+  EXPECT_EQ(chip_.pointer(), 2);
+
+  pca_.readDIP();
+  EXPECT_EQ(chip_.pointer(), 2);
+}
+
+TEST_F(Pca9555Test, BatchedLedChangesAreOneTransaction) {
+  uint64_t transactions = Wire.transactions();
+  pca_.beginBatch();
+  for (uint8_t i = 0; i < PCA9555::NUM_LEDS; ++i) pca_.setLed(i, true);
+  pca_.updateOutputs();
+
+  EXPECT_EQ(Wire.transactions() - transactions, 1u);
+  EXPECT_EQ(chip_.output(0), 0b01010101);
+  EXPECT_EQ(chip_.output(1), 0b00000101);
+  EXPECT_EQ(pca_.transactions(), Wire.transactions());
+}
+
+}  // namespace
@@ -0,0 +1,139 @@
+#include "present_command.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "command.h"
+#include "effect_engine.h"
+#include "host_test.h"
+#include "led_command.h"
+
+namespace {
+
+constexpr size_t kNumLeds = 8;
+
+class PresentCommandTest : public HostTest {
+ protected:
+  PresentCommandTest() {
+    led_.set_backup(backup_);
+    led_.set_engine(&engine_);
+  }
+
+  // kFrameLedTagged frame staging leds as frame id
+  static std::string Tagged(uint16_t id, const std::vector<CRGB>& leds) {
+    std::string tag = {char(id & 0xFF), char(id >> 8)};
+    return BinaryFrame(kFrameLedTagged, tag + LedPayload(leds));
+  }
+
+  // Frame shown after taking the latest one from the slot, or empty
+  std::vector<CRGB> Shown() {
+    if (!slot_.take(micros())) return {};
+    return std::vector<CRGB>(slot_.front(), slot_.front() + kNumLeds);
+  }
+
+  // One loop() pass, kPassMs after the last
+  void Loop() {
+    host_clock::advance_ms(kPassMs);
+    present_.poll(millis());
+    engine_.render(millis());
+  }
+  static constexpr uint32_t kPassMs = 20;
+
+  CRGB frame_[kNumLeds] = {};
+  CRGB backup_[kNumLeds];
+  CRGB staged_[kNumLeds];
+  CRGB from_[kNumLeds];
+  CRGB target_[kNumLeds];
+  CRGB storage_[3 * kNumLeds];
+  FrameSlot slot_{storage_, kNumLeds};
+  LedCommand led_{frame_, kNumLeds, slot_};
+  EffectEngine engine_{frame_, from_, target_, kNumLeds, slot_};
+  PresentCommand present_{led_, staged_, slot_};
+  Command* commands_[2] = {&led_, &present_};
+  CommandProcessor processor_{commands_, Serial};
+};
+
+TEST_F(PresentCommandTest, StagedFrameWaitsForPresent) {
+  std::vector<CRGB> leds = TestPattern(kNumLeds);
+  processor_.process_chars(Tagged(7, leds));
+  Loop();
+  EXPECT_TRUE(Shown().empty());
+
+  processor_.process_chars("present:7\n");
+  EXPECT_EQ(Shown(), leds);
+
+  // Presented once only
+  processor_.process_chars("present:7\n");
+  EXPECT_TRUE(Shown().empty());
+}
+
+TEST_F(PresentCommandTest, DelayedPresentIsShownByPoll) {
+  std::vector<CRGB> leds = TestPattern(kNumLeds);
+  processor_.process_chars(Tagged(7, leds));
+  processor_.process_chars("present:7:50\n");
+
+  Loop();
+  Loop();
+  EXPECT_TRUE(Shown().empty());
+  Loop();  // 60 ms after present
+  EXPECT_EQ(Shown(), leds);
+}
+
+TEST_F(PresentCommandTest, RejectsUnknownIdsAndBadArguments) {
+  processor_.process_chars(Tagged(7, TestPattern(kNumLeds)));
+  processor_.process_chars("present:8\npresent:x\npresent:7:soon\n");
+
+  EXPECT_TRUE(Shown().empty());
+  EXPECT_NE(Serial.output().find("No staged LED frame with ID 8"),
+            std::string::npos);
+  EXPECT_NE(Serial.output().find("Invalid present command format"),
+            std::string::npos);
+}
+
+TEST_F(PresentCommandTest, NewTaggedFrameCancelsAPendingPresent) {
+  std::vector<CRGB> second = TestPattern(kNumLeds, 50);
+  processor_.process_chars(Tagged(1, TestPattern(kNumLeds)));
+  processor_.process_chars("present:1:30\n");
+  processor_.process_chars(Tagged(2, second));
+  Loop();
+  Loop();
+  EXPECT_TRUE(Shown().empty());
+
+  processor_.process_chars("present:1\npresent:2\n");
+  EXPECT_EQ(Shown(), second);
+}
+
+TEST_F(PresentCommandTest, CorruptTaggedFrameKeepsTheStagedOne) {
+  std::vector<CRGB> leds = TestPattern(kNumLeds);
+  processor_.process_chars(Tagged(1, leds));
+  std::string corrupt = Tagged(2, TestPattern(kNumLeds, 50));
+  corrupt.back() ^= 0xFF;
+  processor_.process_chars(corrupt);
+
+  processor_.process_chars("present:2\npresent:1\n");
+  EXPECT_EQ(Shown(), leds);
+}
+
+// A tagged frame split across loop() passes while an effect runs must be
+// staged intact, without the effect drawing into or showing it half decoded
+TEST_F(PresentCommandTest, TaggedFrameArrivingWhileAnEffectRenders) {
+  engine_.hue(1000, 256, 255);
+  Loop();
+  Shown();
+
+  std::vector<CRGB> leds(kNumLeds, CRGB::Blue);
+  std::string frame = Tagged(3, leds);
+  processor_.process_chars(frame.substr(0, 14));  // Header, tag, count, 2 LEDs
+  Loop();
+  EXPECT_TRUE(Shown().empty());
+  processor_.process_chars(frame.substr(14));
+  Loop();
+  EXPECT_TRUE(Shown().empty());
+
+  processor_.process_chars("present:3\n");
+  EXPECT_EQ(Shown(), leds);
+}
+
+}  // namespace
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include "ch9120.h"
+#include "fake_ch9121.h"
+#include "host_test.h"
+#include "reconf_command.h"
+#include "tx_queue.h"
+
+namespace {
+
+constexpr uint8_t kRstPin = 19;
+constexpr uint8_t kCfgPin = 18;
+
+const CH9121Config kConfig = {
+    .gateway = {192, 168, 0, 1},
+    .subnet_mask = {255, 255, 255, 0},
+    .local_ip = {192, 168, 0, 51},
+    .target_ip = {192, 168, 0, 1},
+    .local_port = 51333,
+    .target_port = 51334,
+    .baud_rate = 921600,
+    .mode = 0x00,
+};
+
+class ReconfCommandTest : public HostTest {
+ protected:
+  ReconfCommandTest() {
+    ch9121_.Begin();
+    Serial2.begin(kConfig.baud_rate);
+  }
+
+  // Run loop() as the sketch does, 1 ms apart, until the reconfiguration has
+  // finished and every reply has been sent
+  void RunLoop() {
+    do {
+      bool reconfiguring = reconf_.step();
+      if (!reconfiguring) tx_.service();
+      host_clock::advance_ms(1);
+    } while (ch9121_.Busy() || !tx_.empty());
+  }
+
+  // Network data sent since the last call
+  std::string TakeNetwork() {
+    std::string sent = module_.network().substr(network_read_);
+    network_read_ = module_.network().size();
+    return sent;
+  }
+
+  FakeCh9121 module_{Serial2, kCfgPin};
+  CH9121 ch9121_{&Serial2, kConfig, kRstPin, kCfgPin};
+  TxQueue tx_{&Serial2};
+  ReconfCommand reconf_{ch9121_, tx_};
+  size_t network_read_ = 0;
+};
+
+TEST_F(ReconfCommandTest, RepliesStartedBeforeEnteringConfigMode) {
+  reconf_.process("192.168.0.7:50000");
+  RunLoop();
+
+  // Only bytes written outside configuration mode reach the network
+  EXPECT_EQ(TakeNetwork(),
+            "{\"reconf\":\"started\"}\r\n"
+            "{\"reconf\":\"done\",\"written\":7}\r\n");
+  EXPECT_EQ(module_.saves(), 1);
+}
+
+TEST_F(ReconfCommandTest, StatusRepeatsTheLastResult) {
+  reconf_.process("status");
+  RunLoop();
+  EXPECT_EQ(TakeNetwork(), "{\"reconf\":\"idle\",\"written\":0}\r\n");
+
+  reconf_.process("192.168.0.7:50000");
+  reconf_.process("status");
+  RunLoop();
+  EXPECT_EQ(TakeNetwork(),
+            "{\"reconf\":\"started\"}\r\n"
+            "{\"reconf\":\"busy\",\"written\":0}\r\n"
+            "{\"reconf\":\"done\",\"written\":7}\r\n");
+
+  // As asked by a host that lost the reply when the module reset
+  reconf_.process("status");
+  RunLoop();
+  EXPECT_EQ(TakeNetwork(), "{\"reconf\":\"done\",\"written\":7}\r\n");
+}
+
+TEST_F(ReconfCommandTest, RejectsAnInvalidTarget) {
+  reconf_.process("192.168.0.300:50000");
+  RunLoop();
+
+  EXPECT_EQ(TakeNetwork(), "");
+  EXPECT_EQ(module_.writes(), 0);
+}
+
+}  // namespace
@@ -0,0 +1,109 @@
+#include "sequenced_led_command.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "command.h"
+#include "host_test.h"
+
+namespace {
+
+constexpr size_t kNumLeds = 4;
+
+class SequencedLedCommandTest : public HostTest {
+ protected:
+  // Send a frame numbered seq, all LEDs set to level
+  void Send(uint16_t seq, uint8_t level, bool corrupt = false) {
+    std::string payload = {char(seq & 0xFF), char(seq >> 8)};
+    payload += LedPayload(std::vector<CRGB>(kNumLeds, CRGB(level, 0, 0)));
+    std::string frame = BinaryFrame(kFrameLedSeq, payload);
+    if (corrupt) frame.back() ^= 0xFF;
+    processor_.process_chars(frame);
+  }
+
+  // Red level of the frame shown since the last call, or -1 for none
+  int Shown() {
+    if (!slot_.take(micros())) return -1;
+    return slot_.front()[0].r;
+  }
+
+  CRGB frame_[kNumLeds] = {};
+  CRGB storage_[3 * kNumLeds];
+  FrameSlot slot_{storage_, kNumLeds};
+  LedCommand led_{frame_, kNumLeds, slot_};
+  FirmwareStats stats_;
+  SequencedLedCommand sequenced_{led_, stats_};
+  Command* commands_[1] = {&sequenced_};
+  CommandProcessor processor_{commands_, Serial};
+};
+
+TEST_F(SequencedLedCommandTest, ShowsFramesAfterDroppedOnes) {
+  Send(1, 10);
+  EXPECT_EQ(Shown(), 10);
+  Send(4, 40);  // 2 and 3 lost
+  EXPECT_EQ(Shown(), 40);
+  EXPECT_EQ(stats_.stale_frames, 0u);
+}
+
+TEST_F(SequencedLedCommandTest, DropsDuplicates) {
+  Send(7, 70);
+  Shown();
+  Send(7, 71);
+
+  EXPECT_EQ(Shown(), -1);
+  EXPECT_EQ(frame_[0].r, 70);
+  EXPECT_EQ(stats_.stale_frames, 1u);
+}
+
+TEST_F(SequencedLedCommandTest, DropsFramesArrivingOutOfOrder) {
+  Send(5, 50);
+  Shown();
+  Send(3, 30);
+  Send(4, 40);
+  EXPECT_EQ(Shown(), -1);
+  EXPECT_EQ(stats_.stale_frames, 2u);
+
+  Send(6, 60);
+  EXPECT_EQ(Shown(), 60);
+}
+
+TEST_F(SequencedLedCommandTest, SequenceNumbersWrapAround) {
+  Send(0xFFFE, 1);
+  Send(0xFFFF, 2);
+  Send(0, 3);
+  Send(1, 4);
+  EXPECT_EQ(slot_.published(), 4u);
+  EXPECT_EQ(Shown(), 4);
+
+  Send(0xFFFF, 5);  // Late, from before the wrap
+  EXPECT_EQ(Shown(), -1);
+  EXPECT_EQ(stats_.stale_frames, 1u);
+}
+
+TEST_F(SequencedLedCommandTest, FollowsASenderThatRestarted) {
+  Send(1000, 10);
+  Send(1000 - SequencedLedCommand::RESYNC_DISTANCE, 20);
+  EXPECT_EQ(stats_.stale_frames, 1u);
+
+  Send(1000 - SequencedLedCommand::RESYNC_DISTANCE - 1, 30);
+  Shown();
+  Send(0, 40);  // The next restart, numbering from 0
+  EXPECT_EQ(Shown(), 40);
+  Send(1, 50);
+  EXPECT_EQ(Shown(), 50);
+  EXPECT_EQ(stats_.stale_frames, 1u);
+}
+
+TEST_F(SequencedLedCommandTest, CorruptFramesDoNotAdvanceTheSequence) {
+  Send(1, 10);
+  Shown();
+  Send(2, 20, /*corrupt=*/true);
+  EXPECT_EQ(Shown(), -1);
+
+  Send(2, 21);  // Resent intact
+  EXPECT_EQ(Shown(), 21);
+}
+
+}  // namespace
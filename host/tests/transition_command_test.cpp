@@ -0,0 +1,85 @@
+#include "transition_command.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "command.h"
+#include "effect_engine.h"
+#include "host_test.h"
+#include "led_command.h"
+
+namespace {
+
+constexpr size_t kNumLeds = 8;
+
+class TransitionCommandTest : public HostTest {
+ protected:
+  TransitionCommandTest() { led_.set_backup(backup_); }
+
+  // Keyframe frame blending to leds over duration_ms
+  static std::string Keyframe(const std::vector<CRGB>& leds,
+                              uint16_t duration_ms) {
+    std::string header = {char(duration_ms & 0xFF), char(duration_ms >> 8),
+                          char(EffectEngine::kLinear)};
+    return BinaryFrame(kFrameLedTransition, header + LedPayload(leds));
+  }
+
+  CRGB frame_[kNumLeds] = {};
+  CRGB backup_[kNumLeds];
+  CRGB from_[kNumLeds];
+  CRGB target_[kNumLeds];
+  CRGB storage_[3 * kNumLeds];
+  FrameSlot slot_{storage_, kNumLeds};
+  LedCommand led_{frame_, kNumLeds, slot_};
+  EffectEngine engine_{frame_, from_, target_, kNumLeds, slot_};
+  TransitionCommand transition_{led_, engine_};
+  Command* commands_[2] = {&led_, &transition_};
+  CommandProcessor processor_{commands_, Serial};
+};
+
+TEST_F(TransitionCommandTest, BlendsToTheKeyframe) {
+  std::vector<CRGB> keyframe(kNumLeds, CRGB::White);
+  processor_.process_chars(Keyframe(keyframe, 100));
+
+  host_clock::advance_ms(50);
+  engine_.render(millis());
+  EXPECT_EQ(frame_[0], CRGB(128, 128, 128));
+  host_clock::advance_ms(50);
+  engine_.render(millis());
+  EXPECT_EQ(frame_[0], CRGB(CRGB::White));
+}
+
+TEST_F(TransitionCommandTest, CorruptKeyframeLeavesTheEffectRunning) {
+  engine_.chase(CRGB::Red, kNumLeds * 10, 1);
+  engine_.render(millis());
+
+  std::string frame = Keyframe(TestPattern(kNumLeds), 100);
+  frame.back() ^= 0xFF;  // Bad CRC
+  processor_.process_chars(frame);
+
+  EXPECT_TRUE(engine_.running());
+  host_clock::advance_ms(30);
+  engine_.render(millis());
+  EXPECT_EQ(frame_[3], CRGB(CRGB::Red));
+  EXPECT_EQ(frame_[0], CRGB(CRGB::Black));
+}
+
+TEST_F(TransitionCommandTest, CorruptKeyframeLeavesATransitionRunning) {
+  std::vector<CRGB> keyframe(kNumLeds, CRGB::White);
+  processor_.process_chars(Keyframe(keyframe, 100));
+  host_clock::advance_ms(50);
+  engine_.render(millis());
+
+  std::string frame = Keyframe(TestPattern(kNumLeds), 100);
+  frame.back() ^= 0xFF;
+  processor_.process_chars(frame);
+
+  EXPECT_EQ(frame_[0], CRGB(128, 128, 128));
+  host_clock::advance_ms(50);
+  engine_.render(millis());
+  EXPECT_EQ(frame_[0], CRGB(CRGB::White));
+}
+
+}  // namespace
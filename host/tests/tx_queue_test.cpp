@@ -0,0 +1,84 @@
+#include "tx_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "host_test.h"
+
+namespace {
+
+class TxQueueTest : public HostTest {
+ protected:
+  // Queue and commit message, returning commit()'s result
+  bool Queue(const std::string& message) {
+    tx_.print(message.c_str());
+    return tx_.commit();
+  }
+
+  // Service the queue until it is empty, with the UART taking up to space
+  // bytes per pass, and return what was sent
+  std::string Drain(int space) {
+    Serial2.set_write_space(space);
+    for (int pass = 0; !tx_.empty() && pass < 1000; ++pass) tx_.service();
+    return Serial2.take_output();
+  }
+
+  TxQueue tx_{&Serial2};
+};
+
+TEST_F(TxQueueTest, MessagesWrapAroundTheEndOfTheRing) {
+  std::string first(3000, 'a');
+  std::string second = std::string(1500, 'b') + std::string(1500, 'c');
+  ASSERT_TRUE(Queue(first));
+  EXPECT_EQ(Drain(700), first);
+
+  // Starts 3000 bytes in, so it continues from the start of the ring
+  ASSERT_TRUE(Queue(second));
+  EXPECT_EQ(Drain(700), second);
+  EXPECT_EQ(tx_.space(), TxQueue::CAPACITY);
+}
+
+TEST_F(TxQueueTest, NothingIsSentWhileTheUartIsFull) {
+  Serial2.set_write_space(0);
+  ASSERT_TRUE(Queue("hello\n"));
+  tx_.service();
+
+  EXPECT_FALSE(tx_.empty());
+  EXPECT_EQ(Serial2.take_output(), "");
+  EXPECT_EQ(Drain(2), "hello\n");
+}
+
+TEST_F(TxQueueTest, CommitFailsWhenTheQueueIsFull) {
+  Serial2.set_write_space(0);
+  std::string big(TxQueue::CAPACITY - 10, 'x');
+  ASSERT_TRUE(Queue(big));
+
+  EXPECT_FALSE(Queue("more than ten bytes\n"));
+  EXPECT_EQ(tx_.dropped(), 1u);
+  EXPECT_EQ(tx_.space(), 10u);
+
+  // A message that fits still goes out after the queued one
+  EXPECT_TRUE(Queue("fits\n"));
+  EXPECT_EQ(Drain(512), big + "fits\n");
+}
+
+TEST_F(TxQueueTest, FailedMessagesAreRolledBackWhole) {
+  Serial2.set_write_space(0);
+  std::string big(TxQueue::CAPACITY - 100, 'x');
+  ASSERT_TRUE(Queue(big));
+
+  // The first part fits, the second does not, and the rest of the message is
+  // refused too even though it would fit
+  EXPECT_EQ(tx_.print(std::string(60, 'y').c_str()), 60u);
+  EXPECT_EQ(tx_.print(std::string(60, 'z').c_str()), 0u);
+  EXPECT_EQ(tx_.print("\n"), 0u);
+  EXPECT_FALSE(tx_.commit());
+  EXPECT_EQ(tx_.space(), 100u);
+
+  EXPECT_TRUE(Queue("next\n"));
+  EXPECT_EQ(Drain(512), big + "next\n");
+  EXPECT_EQ(tx_.dropped(), 1u);
+}
+
+}  // namespace
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <Arduino.h>
+#include <stdint.h>
+
+// Log2 histogram of durations in microseconds. Bucket 0 counts 0 us, bucket i
+// counts [2^(i-1), 2^i) us and the last bucket everything longer.
+class LatencyHistogram {
+ public:
+  static constexpr int BUCKETS = 16;
+
+  void record(uint32_t us) {
+    int bucket = us ? 32 - __builtin_clz(us) : 0;
+    if (bucket >= BUCKETS) bucket = BUCKETS - 1;
+    ++buckets_[bucket];
+    ++count_;
+    if (us > max_us_) max_us_ = us;
+  }
+
+  uint32_t count() const { return count_; }
+  uint32_t max_us() const { return max_us_; }
+
+  // Print as {"n":count,"max":max_us,"hist":[...]}
+  void print_json(Print& out) const {
+    out.print("{\"n\":");
+    out.print(count_);
+    out.print(",\"max\":");
+    out.print(max_us_);
+    out.print(",\"hist\":[");
+    for (int i = 0; i < BUCKETS; ++i) {
+      if (i) out.print(',');
+      out.print(buckets_[i]);
+    }
+    out.print("]}");
+  }
+
+ private:
+  uint32_t buckets_[BUCKETS] = {};
+  uint32_t count_ = 0;
+  uint32_t max_us_ = 0;
+};
@@ -1,23 +1,22 @@
 #pragma once
 
-#include <LiquidCrystal_PCF8574.h>
-
-#include <functional>
 #include <string_view>
 
 #include "command.h"
+#include "lcd_framebuffer.h"
 
 class LcdCommand : public Command {
  public:
-  LcdCommand(LiquidCrystal_PCF8574& lcd, uint8_t width, uint8_t height)
-      : Command("lcd"), lcd_(lcd), width_(width), height_(height) {}
+  LcdCommand(LcdFramebuffer& lcd)
+      : Command("lcd"), lcd_(lcd), width_(lcd.width()), height_(lcd.height()) {}
 
   void process(std::string_view args) override;
 
-  std::function<void()> on_clear;
+  // Called after "lcd:clear"
+  void (*on_clear)() = nullptr;
 
  private:
-  LiquidCrystal_PCF8574& lcd_;
+  LcdFramebuffer& lcd_;
   const uint8_t width_;
   const uint8_t height_;
 
@@ -0,0 +1,78 @@
+#include "lcd_framebuffer.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+LcdFramebuffer::LcdFramebuffer(LiquidCrystal_PCF8574& lcd, uint8_t width,
+                               uint8_t height)
+    : lcd_(lcd),
+      width_(std::min(width, MAX_WIDTH)),
+      height_(std::min(height, MAX_HEIGHT)) {
+  reset();
+}
+
+void LcdFramebuffer::reset() {
+  memset(cells_, ' ', sizeof(cells_));
+  memset(shown_, ' ', sizeof(shown_));
+  dirty_rows_ = 0;
+  cursor_x_ = cursor_y_ = 0;
+  lcd_x_ = width_;
+  lcd_y_ = 0;
+}
+
+void LcdFramebuffer::clear() {
+  memset(cells_, ' ', sizeof(cells_));
+  dirty_rows_ = (1 << height_) - 1;
+  cursor_x_ = cursor_y_ = 0;
+}
+
+void LcdFramebuffer::setCursor(uint8_t x, uint8_t y) {
+  cursor_x_ = x;
+  cursor_y_ = y;
+}
+
+size_t LcdFramebuffer::write(uint8_t c) {
+  if (cursor_x_ >= width_ || cursor_y_ >= height_) return 0;
+  if (cells_[cursor_y_][cursor_x_] != c) {
+    cells_[cursor_y_][cursor_x_] = c;
+    dirty_rows_ |= 1 << cursor_y_;
+  }
+  ++cursor_x_;
+  return 1;
+}
+
+void LcdFramebuffer::flush(uint32_t budget_us) {
+  uint32_t start = micros();
+  for (uint8_t y = 0; y < height_; ++y) {
+    if (!(dirty_rows_ & (1 << y))) continue;
+
+    uint8_t x = 0;
+    while (x < width_) {
+      if (cells_[y][x] == shown_[y][x]) {
+        ++x;
+        continue;
+      }
+
+      // Repositioning costs about as much as rewriting one character, so
+      // only move the cursor if it is not already here
+      if (lcd_y_ != y || lcd_x_ != x) {
+        lcd_.setCursor(x, y);
+        ++lcd_writes_;
+      }
+      // Write the run of changed cells, bridging single unchanged cells
+      while (x < width_ &&
+             (cells_[y][x] != shown_[y][x] ||
+              (x + 1 < width_ && cells_[y][x + 1] != shown_[y][x + 1]))) {
+        lcd_.write(cells_[y][x]);
+        ++lcd_writes_;
+        shown_[y][x] = cells_[y][x];
+        ++x;
+        lcd_x_ = x;
+        lcd_y_ = y;
+        if (micros() - start >= budget_us) return;
+      }
+    }
+    dirty_rows_ &= ~(1 << y);
+  }
+}
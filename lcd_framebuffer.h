@@ -0,0 +1,52 @@
+#pragma once
+
+#include <Arduino.h>
+#include <LiquidCrystal_PCF8574.h>
+
+// In-RAM copy of the character LCD. Writes only update RAM; flush() sends the
+// cells that differ from what the display shows, a run at a time, and stops
+// when its time budget is used up so a repaint never blocks loop() for long.
+class LcdFramebuffer : public Print {
+ public:
+  static constexpr uint8_t MAX_WIDTH = 20;
+  static constexpr uint8_t MAX_HEIGHT = 4;
+
+  LcdFramebuffer(LiquidCrystal_PCF8574& lcd, uint8_t width, uint8_t height);
+
+  // Forget the display contents; call after clearing the LCD directly
+  void reset();
+
+  // Fill the framebuffer with spaces and move the cursor home
+  void clear();
+  void setCursor(uint8_t x, uint8_t y);
+
+  // Write a character at the cursor. Text past the end of a row is dropped.
+  size_t write(uint8_t c) override;
+  using Print::write;
+
+  // Send changed cells to the LCD until budget_us has elapsed
+  void flush(uint32_t budget_us);
+
+  uint8_t width() const { return width_; }
+  uint8_t height() const { return height_; }
+
+  // Number of cursor moves and characters sent to the display so far
+  uint32_t lcd_writes() const { return lcd_writes_; }
+
+ private:
+  LiquidCrystal_PCF8574& lcd_;
+  const uint8_t width_;
+  const uint8_t height_;
+
+  char cells_[MAX_HEIGHT][MAX_WIDTH];  // Desired contents
+  char shown_[MAX_HEIGHT][MAX_WIDTH];  // Contents on the display
+  uint8_t dirty_rows_ = 0;             // Rows where cells_ may differ
+  uint32_t lcd_writes_ = 0;
+
+  uint8_t cursor_x_ = 0;
+  uint8_t cursor_y_ = 0;
+
+  // Position of the display's own cursor, or width_ if unknown
+  uint8_t lcd_x_ = 0;
+  uint8_t lcd_y_ = 0;
+};
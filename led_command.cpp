@@ -2,6 +2,7 @@
 
 #include <stddef.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <algorithm>
 #include <string_view>
@@ -51,35 +52,172 @@ bool LedCommand::parse_rgb(std::string_view str, uint8_t& r, uint8_t& g,
 }
 
 void LedCommand::process(std::string_view args) {
-  static uint32_t last_update = 0;
-  static float avg_rate = 0.0f;
-  const float alpha = 0.1f;  // Filter coefficient
-
-  uint32_t now = millis();
-  if (last_update > 0) {
-    float dt = (now - last_update) / 1000.0f;
-    if (dt > 0) {
-      float instant_rate = 1.0f / dt;
-      avg_rate = alpha * instant_rate + (1.0f - alpha) * avg_rate;
+  begin_stream();
+  stream(args);
+  end_stream();
+}
+
+void LedCommand::begin_stream() {
+  decoder_.Reset();
+  decode_ok_ = true;
+  reset_frame();
+}
+
+void LedCommand::begin_frame(size_t length) { reset_frame(); }
+
+void LedCommand::frame_data(std::span<const uint8_t> data) {
+  for (uint8_t byte : data) {
+    consume(byte);
+  }
+}
+
+void LedCommand::end_frame(bool valid) { finish_frame(valid); }
+
+void LedCommand::reset_frame() {
+  stopped_effect_ = engine_ && engine_->running();
+  if (stopped_effect_) engine_->capture();
+  if (backup_) memcpy(backup_, leds_, num_leds_ * sizeof(CRGB));
+  header_pos_ = 0;
+  frame_leds_ = 0;
+  pixel_ = 0;
+  channel_ = 0;
+  patch_ok_ = true;
+  op_ = OP_PAD;
+  field_pos_ = 0;
+  in_header_ = false;
+  elements_ = 0;
+}
+
+void LedCommand::stream(std::string_view chunk) {
+  uint8_t decoded[64];
+  while (decode_ok_ && !chunk.empty()) {
+    std::string_view piece = chunk.substr(0, sizeof(decoded));
+    chunk.remove_prefix(piece.size());
+
+    int count = decoder_.Decode(
+        std::span<const uint8_t>((const uint8_t*)piece.data(), piece.size()),
+        decoded);
+    if (count < 0) {
+      decode_ok_ = false;
+      break;
+    }
+    for (int i = 0; i < count; ++i) {
+      consume(decoded[i]);
     }
   }
-  last_update = now;
-
-  if (Base64Decode(
-          std::span<const uint8_t>((const uint8_t*)args.data(), args.size()),
-          std::span(led_control_buffer_.raw,
-                    sizeof(led_control_buffer_.raw)))) {
-    auto& control = led_control_buffer_.control;
-    for (int i = 0; i < num_leds_ && i < control.num_leds; ++i) {
-      leds_[i] = CRGB(control.data[i].r, control.data[i].g, control.data[i].b);
+}
+
+void LedCommand::consume(uint8_t byte) {
+  if (header_pos_ < sizeof(frame_leds_)) {
+    frame_leds_ |= byte << (8 * header_pos_++);
+    return;
+  }
+  if (frame_leds_ == PATCH_FRAME) {
+    consume_patch(byte);
+    return;
+  }
+
+  if (pixel_ < num_leds_ && pixel_ < frame_leds_) {
+    leds_[pixel_][channel_] = byte;
+  }
+  if (++channel_ == 3) {
+    channel_ = 0;
+    ++pixel_;
+  }
+}
+
+// Size of the header following each op, and of each element after it
+static constexpr uint8_t kPatchHeaderSize[] = {0, 3, 7, 3};
+static constexpr uint8_t kPatchElementSize[] = {0, 3, 0, 4};
+
+void LedCommand::consume_patch(uint8_t byte) {
+  if (!patch_ok_) return;
+
+  if (!in_header_ && elements_ == 0) {
+    // Start of a record
+    if (byte == OP_PAD) return;
+    if (byte > OP_RUNS) {
+      patch_ok_ = false;
+      return;
     }
-    FastLED.show();
+    op_ = byte;
+    field_pos_ = 0;
+    in_header_ = true;
+    return;
+  }
+
+  field_[field_pos_++] = byte;
+  if (in_header_) {
+    if (field_pos_ < kPatchHeaderSize[op_]) return;
+    in_header_ = false;
+    field_pos_ = 0;
+    pixel_ = field_[0] | (field_[1] << 8);
+    switch (op_) {
+      case OP_SET:
+      case OP_RUNS:
+        elements_ = field_[2];
+        break;
+      case OP_FILL:
+        fill(field_[2] | (field_[3] << 8), &field_[4]);
+        break;
+    }
+    return;
+  }
+
+  if (field_pos_ < kPatchElementSize[op_]) return;
+  field_pos_ = 0;
+  --elements_;
+  if (op_ == OP_SET) {
+    fill(1, field_);
+  } else {
+    fill(field_[0], &field_[1]);
+  }
+}
+
+void LedCommand::fill(size_t count, const uint8_t* rgb) {
+  CRGB color(rgb[0], rgb[1], rgb[2]);
+  for (; count > 0 && pixel_ < num_leds_; --count) {
+    leds_[pixel_++] = color;
+  }
+  pixel_ += count;
+}
 
-    char tx_buf[128];
-    int formatted =
-        snprintf(tx_buf, 128, "up %d %.1f Hz\n", control.num_leds, avg_rate);
-    Serial.write(tx_buf, formatted);
+void LedCommand::end_stream() {
+  if (decode_ok_ && decoder_.Finish()) {
+    finish_frame(true);
   } else {
     Serial.println("Failed to decode base64 LED data");
+    discard_frame();
+  }
+}
+
+void LedCommand::finish_frame(bool valid) {
+  held_ok_ = false;
+  // A patch frame must end on a record boundary
+  if (frame_leds_ == PATCH_FRAME && (in_header_ || elements_ > 0)) {
+    patch_ok_ = false;
   }
+  if (!patch_ok_) {
+    Serial.println("Invalid LED patch frame");
+    discard_frame();
+  } else if (valid && hold_) {
+    held_ok_ = true;
+    return;
+  } else if (valid) {
+    frames_.publish(leds_);
+    if (acks_) {
+      acks_->print("{\"ack\":");
+      acks_->print(frames_.published());
+      acks_->println("}");
+      acks_->commit();
+    }
+  } else {
+    Serial.println("Dropped corrupt or incomplete LED frame");
+    discard_frame();
+  }
+}
+
+void LedCommand::discard_frame() {
+  if (backup_) memcpy(leds_, backup_, num_leds_ * sizeof(CRGB));
+  if (stopped_effect_) engine_->restore();
 }
@@ -4,32 +4,118 @@
 
 #include "base64.h"
 #include "command.h"
+#include "effect_engine.h"
+#include "frame_slot.h"
+#include "tx_queue.h"
 
-__attribute__((packed)) struct RGBval {
-  uint8_t r, g, b;
-};
-
-__attribute__((packed)) struct LedControl {
-  uint16_t num_leds;
-  RGBval data[];
-};
-
-union LedControlBuffer {
-  LedControl control;
-  uint8_t raw[4096];
-};
-
+// LED frames are a little-endian uint16_t LED count followed by one r, g, b
+// triple per LED, either base64 encoded on an "led:" line or raw in a kFrameLed
+// binary frame. Frames are decoded straight into the LED buffer as they stream
+// in, so their length is not bounded by any line buffer, and completed frames
+// are published to the core that drives the LEDs.
+//
+// A count of PATCH_FRAME instead starts a patch frame, a sequence of records
+// applied on top of the current frame (multi-byte fields are little-endian):
+//   OP_PAD                                  ignored, e.g. base64 padding
+//   OP_SET  start:u16 count:u8  count * rgb  consecutive LEDs from start
+//   OP_FILL start:u16 count:u16 rgb          count LEDs from start
+//   OP_RUNS start:u16 runs:u8   runs * (length:u8 rgb)  run-length encoded
 class LedCommand : public Command {
  public:
-  LedCommand(CRGB* leds, size_t num_leds)
-      : Command("led"), leds_(leds), num_leds_(num_leds) {}
+  LedCommand(CRGB* leds, size_t num_leds, FrameSlot& frames)
+      : Command("led", /*streaming=*/true, kFrameLed),
+        leds_(leds),
+        num_leds_(num_leds),
+        frames_(frames) {}
 
   void process(std::string_view args) override;
 
+  void begin_stream() override;
+  void stream(std::string_view chunk) override;
+  void end_stream() override;
+
+  void begin_frame(size_t length) override;
+  void frame_data(std::span<const uint8_t> data) override;
+  void end_frame(bool valid) override;
+
+  // Acknowledge each published frame with {"ack":<frames published>} on tx,
+  // or stop acknowledging if tx is null
+  void set_acks(TxQueue* tx) { acks_ = tx; }
+
+  // Copy the LED buffer to backup (num_leds LEDs) before each frame, and put
+  // it back if the frame turns out to be invalid, so patch frames that follow
+  // apply to the last good frame rather than to a half-decoded one. Without a
+  // backup, an invalid frame's decoded pixels stay in the buffer unshown.
+  void set_backup(CRGB* backup) { backup_ = backup; }
+
+  // Stop engine's running effect when a frame starts arriving, so it does not
+  // draw over the frame as it is decoded into the LED buffer. The effect stays
+  // stopped once the frame is complete, or resumes if the frame is invalid.
+  // A running transition jumps to its keyframe first, so patch frames apply
+  // to the keyframe the host last sent.
+  void set_engine(EffectEngine* engine) { engine_ = engine; }
+
+  // While held, complete frames are left in the LED buffer instead of being
+  // published, and held_frame_ok() tells whether the last one was intact
+  void set_hold(bool hold) { hold_ = hold; }
+  bool held_frame_ok() const { return held_ok_; }
+
+  const CRGB* leds() const { return leds_; }
+  size_t num_leds() const { return num_leds_; }
+
+  static constexpr uint16_t PATCH_FRAME = 0xFFFF;
+  enum PatchOp : uint8_t {
+    OP_PAD = 0x00,
+    OP_SET = 0x01,
+    OP_FILL = 0x02,
+    OP_RUNS = 0x03,
+  };
+
  private:
   CRGB* leds_;
   size_t num_leds_;
-  LedControlBuffer led_control_buffer_;
+  FrameSlot& frames_;
+  TxQueue* acks_ = nullptr;
+  CRGB* backup_ = nullptr;
+  EffectEngine* engine_ = nullptr;
+  bool stopped_effect_ = false;  // Whether this frame stopped engine_
+  bool hold_ = false;
+  bool held_ok_ = false;
+
+  // Decoding state of the frame currently streaming in
+  Base64Decoder decoder_;
+  bool decode_ok_ = false;
+  size_t header_pos_ = 0;
+  uint16_t frame_leds_ = 0;
+  size_t pixel_ = 0;
+  uint8_t channel_ = 0;
+
+  // Patch frame record being parsed
+  bool patch_ok_ = true;
+  uint8_t op_ = OP_PAD;
+  uint8_t field_[7];       // Record header, then one element
+  uint8_t field_pos_ = 0;  // Bytes of field_ received
+  bool in_header_ = false;
+  uint16_t elements_ = 0;  // Elements left in the record
+
+  // Reset the decoding state for a new frame
+  void reset_frame();
+
+  // Consume one decoded byte of the frame
+  void consume(uint8_t byte);
+
+  // Consume one byte of a patch frame
+  void consume_patch(uint8_t byte);
+
+  // Set count LEDs starting at pixel_ to color, clipped to the strip
+  void fill(size_t count, const uint8_t* rgb);
+
+  // Publish the frame if it was received intact
+  void finish_frame(bool valid);
+
+  // Undo an invalid frame from backup_, if there is one, and resume the
+  // effect it stopped
+  void discard_frame();
 
   // Helper function to parse RGB values
   bool parse_rgb(std::string_view str, uint8_t& r, uint8_t& g, uint8_t& b);
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <FastLED.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// A set of LED strips driven in parallel, one per data pin. The LED buffer is
+// split evenly between the lanes in pin order. On the RP2040 each lane gets
+// its own PIO state machine and DMA channel, so FastLED.show() clocks the
+// lanes out concurrently and its time grows with the longest lane rather
+// than with the total number of LEDs.
+template <uint8_t... Pins>
+struct LedLanes {
+  static constexpr size_t COUNT = sizeof...(Pins);
+
+  // Register the lanes with FastLED, num_leds / COUNT LEDs each
+  static void add(CRGB* leds, size_t num_leds) {
+    size_t per_lane = num_leds / COUNT;
+    size_t lane = 0;
+    (FastLED.addLeds<NEOPIXEL, Pins>(leds + per_lane * lane++, per_lane), ...);
+  }
+};
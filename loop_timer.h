@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+
+// Accumulates loop() iteration times between reports.
+class LoopTimer {
+ public:
+  // Record one iteration that took duration_us
+  void record(uint32_t duration_us) {
+    ++iterations_;
+    total_us_ += duration_us;
+    if (duration_us > max_us_) max_us_ = duration_us;
+  }
+
+  uint32_t iterations() const { return iterations_; }
+  uint32_t average_us() const {
+    return iterations_ ? total_us_ / iterations_ : 0;
+  }
+  uint32_t max_us() const { return max_us_; }
+
+  void reset() {
+    iterations_ = 0;
+    total_us_ = 0;
+    max_us_ = 0;
+  }
+
+ private:
+  uint32_t iterations_ = 0;
+  uint32_t total_us_ = 0;
+  uint32_t max_us_ = 0;
+};
@@ -1,5 +1,4 @@
 import asyncio
-import random
 import textwrap  # Import textwrap module
 from control_port import ControlPort
 
@@ -16,29 +15,6 @@ DEFAULT_JOKE = "Press a button for a joke!"
 LAST_BUTTON_PRESS = {}
 
 
-async def generate_random_color():
-    hue = random.random()  # Random hue between 0 and 1
-    # Convert HSV to RGB with S=1, V=0.25 (64/255)
-    h = hue * 6
-    c = 64  # Intensity/Value
-    x = c * (1 - abs((h % 2) - 1))
-
-    if h < 1:
-        r, g, b = c, x, 0
-    elif h < 2:
-        r, g, b = x, c, 0
-    elif h < 3:
-        r, g, b = 0, c, x
-    elif h < 4:
-        r, g, b = 0, x, c
-    elif h < 5:
-        r, g, b = x, 0, c
-    else:
-        r, g, b = c, 0, x
-
-    return (int(r), int(g), int(b))
-
-
 # --- Button Callback ---
 def handle_button_press(buttons, ip, ctrl):
     global LAST_BUTTON_PRESS
@@ -102,25 +78,24 @@ async def main():
         )
         LAST_BUTTON_PRESS[ip] = -1  # Initialize last state
 
-    # Keep the program running and update LED colors every second
-    led_index = 0  # Restore LED cycling index
-    NUM_LEDS = 1  # Number of LEDs to cycle through
+    # The controllers cycle the LED hues themselves, at a quarter brightness
+    HUE_PERIOD_MS = 5000
+    await asyncio.gather(
+        *[ctrl.set_effect("hue", HUE_PERIOD_MS, 256, 64) for ctrl in controllers.values()]
+    )
+
+    # Keep the program running and cycle the backlights
+    led_index = 0
     NUM_BUTTONS = 6  # Number of buttons to cycle through
     while True:
         tasks = []
         for ip, ctrl in controllers.items():
-            color = await generate_random_color()
-            # Cycle through all LEDs
-            led_states = [(0, 0, 0)] * NUM_LEDS  # Initialize all LEDs to off
-            led_states[led_index % NUM_LEDS] = color  # Set the current LED in the cycle
-            tasks.append(ctrl.set_leds(led_states))
-
             # Only control backlight 4 due to hardware limitations
             backlight_states = [0] * NUM_BUTTONS
             backlight_states[led_index % NUM_BUTTONS] ^= 1  # Always turn on only backlight 4
             tasks.append(ctrl.set_backlights(backlight_states))
 
-        await asyncio.gather(*tasks)  # Run LED/backlight updates concurrently
+        await asyncio.gather(*tasks)  # Run backlight updates concurrently
         led_index += 1  # Increment LED index for the next cycle
         await asyncio.sleep(0.2)  # Keep update cycle
 
@@ -12,17 +12,21 @@ void PCA9555::begin() {
     // IO0_0:5 = LED outputs (0=output), IO0_6:7 = unused (set as input)
     // IO1_0:5 = BUTTON inputs (1=input), IO1_4:7 = DIP inputs (1=input)
     // IO1_6:7 = DIP inputs (1=input)
-    writeRegister(REG_CONFIG_0, 0b10101010); // LED_x as output, BUTTON_x as input
-    writeRegister(REG_CONFIG_1, 0b11111010); // LED_4/5 as output, BUTTON_4/5 and DIP as input
+    config_[0] = 0b10101010; // LED_x as output, BUTTON_x as input
+    config_[1] = 0b11111010; // LED_4/5 as output, BUTTON_4/5 and DIP as input
+    writeRegisterPair(REG_CONFIG_0, config_);
     // Set all LEDs OFF
-    writeRegister(REG_OUTPUT_0, 0x00);
-    writeRegister(REG_OUTPUT_1, 0x00);
+    output_[0] = output_[1] = 0x00;
+    batching_ = false;
+    writeRegisterPair(REG_OUTPUT_0, output_);
+    written_[0] = output_[0];
+    written_[1] = output_[1];
 }
 
 void PCA9555::setLed(uint8_t idx, bool on) {
     if (idx >= NUM_LEDS) return;
-    uint8_t out0 = readRegister(REG_OUTPUT_0);
-    uint8_t out1 = readRegister(REG_OUTPUT_1);
+    uint8_t& out0 = output_[0];
+    uint8_t& out1 = output_[1];
     switch(idx) {
         case 0: if (on) out0 |= (1 << 0); else out0 &= ~(1 << 0); break;
         case 1: if (on) out0 |= (1 << 2); else out0 &= ~(1 << 2); break;
@@ -31,8 +35,7 @@ void PCA9555::setLed(uint8_t idx, bool on) {
         case 4: if (on) out1 |= (1 << 0); else out1 &= ~(1 << 0); break;
         case 5: if (on) out1 |= (1 << 2); else out1 &= ~(1 << 2); break;
     }
-    writeRegister(REG_OUTPUT_0, out0);
-    writeRegister(REG_OUTPUT_1, out1);
+    if (!batching_) updateOutputs();
 }
 
 void PCA9555::setAllLeds(const bool states[NUM_LEDS]) {
@@ -43,13 +46,16 @@ void PCA9555::setAllLeds(const bool states[NUM_LEDS]) {
     if (states[3]) out0 |= (1 << 6);
     if (states[4]) out1 |= (1 << 0);
     if (states[5]) out1 |= (1 << 2);
-    writeRegister(REG_OUTPUT_0, out0);
-    writeRegister(REG_OUTPUT_1, out1);
+    output_[0] = out0;
+    output_[1] = out1;
+    if (!batching_) updateOutputs();
 }
 
 uint8_t PCA9555::readButtons() {
-    uint8_t in0 = readRegister(REG_INPUT_0);
-    uint8_t in1 = readRegister(REG_INPUT_1);
+    uint8_t in[2];
+    readRegisterPair(REG_INPUT_0, in);
+    uint8_t in0 = in[0];
+    uint8_t in1 = in[1];
     uint8_t result = 0;
     if (!(in0 & (1 << 1))) result |= (1 << 0); // BUTTON_0
     if (!(in0 & (1 << 3))) result |= (1 << 1); // BUTTON_1
@@ -65,21 +71,35 @@ uint8_t PCA9555::readDIP() {
     return (in1 >> 4) & 0x0F;
 }
 
+void PCA9555::beginBatch() {
+    batching_ = true;
+}
+
 void PCA9555::updateOutputs() {
-    // Not used in new logic, but could be implemented if needed
+    batching_ = false;
+    if (output_[0] == written_[0] && output_[1] == written_[1]) return;
+    writeRegisterPair(REG_OUTPUT_0, output_);
+    written_[0] = output_[0];
+    written_[1] = output_[1];
 }
 
-void PCA9555::writeRegister(uint8_t reg, uint8_t value) {
+// Registers come in pairs and the chip auto-increments within a pair, so both
+// ports can be written in a single transaction
+void PCA9555::writeRegisterPair(uint8_t reg, const uint8_t values[2]) {
+    ++transactions_;
     wire_.beginTransmission(I2C_ADDR);
     wire_.write(reg);
-    wire_.write(value);
+    wire_.write(values[0]);
+    wire_.write(values[1]);
     wire_.endTransmission();
 }
 
 uint8_t PCA9555::readRegister(uint8_t reg) {
+    ++transactions_;
     wire_.beginTransmission(I2C_ADDR);
     wire_.write(reg);
     wire_.endTransmission(false);
+    ++transactions_;
     wire_.requestFrom(I2C_ADDR, (uint8_t)1);
     uint8_t value = 0xFF;
     if (wire_.available()) {
@@ -90,9 +110,29 @@ uint8_t PCA9555::readRegister(uint8_t reg) {
     // set the register pointer to a non-input register (e.g., 0x02)
     // to prevent INT line issues when accessing other I2C slaves.
     if (reg == REG_INPUT_0 || reg == REG_INPUT_1) {
+        ++transactions_;
         wire_.beginTransmission(I2C_ADDR);
         wire_.write(REG_OUTPUT_0); // Set pointer to output register 0
         wire_.endTransmission();
     }
     return value;
 }
+
+void PCA9555::readRegisterPair(uint8_t reg, uint8_t values[2]) {
+    ++transactions_;
+    wire_.beginTransmission(I2C_ADDR);
+    wire_.write(reg);
+    wire_.endTransmission(false);
+    ++transactions_;
+    wire_.requestFrom(I2C_ADDR, (uint8_t)2);
+    values[0] = wire_.available() ? wire_.read() : 0xFF;
+    values[1] = wire_.available() ? wire_.read() : 0xFF;
+
+    // Same erratum workaround as in readRegister()
+    if (reg == REG_INPUT_0) {
+        ++transactions_;
+        wire_.beginTransmission(I2C_ADDR);
+        wire_.write(REG_OUTPUT_0);
+        wire_.endTransmission();
+    }
+}
@@ -9,14 +9,29 @@ class PCA9555 {
 
   PCA9555(TwoWire& wire = Wire) : wire_(wire) {}
   void begin();
+  // LED changes are kept in a shadow of the output registers and written in
+  // one auto-incremented transaction, only if they changed anything.
   void setLed(uint8_t idx, bool on);
   void setAllLeds(const bool states[NUM_LEDS]);
   uint8_t readButtons();  // returns 6 LSBs as button states
   uint8_t readDIP();      // returns 4 LSBs as DIP value
+
+  // Between beginBatch() and updateOutputs(), LED changes only update the
+  // shadow; updateOutputs() then writes them with at most one transaction.
+  void beginBatch();
   void updateOutputs();
 
+  // Number of I2C transactions issued so far
+  uint32_t transactions() const { return transactions_; }
+
  private:
   TwoWire& wire_;
-  void writeRegister(uint8_t reg, uint8_t value);
+  uint8_t output_[2] = {0x00, 0x00};   // Desired output register values
+  uint8_t written_[2] = {0xFF, 0xFF};  // Output register values on the chip
+  uint8_t config_[2] = {0xFF, 0xFF};   // Configuration register values
+  bool batching_ = false;
+  uint32_t transactions_ = 0;
+  void writeRegisterPair(uint8_t reg, const uint8_t values[2]);
   uint8_t readRegister(uint8_t reg);
+  void readRegisterPair(uint8_t reg, uint8_t values[2]);
 };
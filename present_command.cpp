@@ -0,0 +1,84 @@
+#include "present_command.h"
+
+#include <Arduino.h>
+#include <string.h>
+
+#include <charconv>
+#include <system_error>
+
+void PresentCommand::process(std::string_view args) {
+  // Format: "present:<id>" or "present:<id>:<delay_ms>"
+  std::string_view id_str = args.substr(0, args.find(':'));
+  std::string_view delay_str;
+  if (id_str.size() < args.size()) {
+    delay_str = args.substr(id_str.size() + 1);
+  }
+
+  uint16_t id;
+  uint32_t delay_ms = 0;
+  auto id_result =
+      std::from_chars(id_str.data(), id_str.data() + id_str.size(), id);
+  if (id_result.ec != std::errc() ||
+      id_result.ptr != id_str.data() + id_str.size()) {
+    Serial.println("Invalid present command format");
+    return;
+  }
+  if (!delay_str.empty()) {
+    auto delay_result = std::from_chars(
+        delay_str.data(), delay_str.data() + delay_str.size(), delay_ms);
+    if (delay_result.ec != std::errc() ||
+        delay_result.ptr != delay_str.data() + delay_str.size()) {
+      Serial.println("Invalid present command format");
+      return;
+    }
+  }
+
+  if (!has_staged_ || id != staged_id_) {
+    Serial.print("No staged LED frame with ID ");
+    Serial.println(id);
+    return;
+  }
+  scheduled_ = true;
+  present_at_ms_ = millis() + delay_ms;
+  poll(millis());
+}
+
+void PresentCommand::poll(uint32_t now_ms) {
+  if (!scheduled_ || static_cast<int32_t>(now_ms - present_at_ms_) < 0) return;
+  frames_.publish(staged_);
+  scheduled_ = false;
+  has_staged_ = false;
+}
+
+void PresentCommand::begin_frame(size_t length) {
+  length_ = length;
+  id_pos_ = 0;
+  id_ = 0;
+}
+
+void PresentCommand::frame_data(std::span<const uint8_t> data) {
+  while (id_pos_ < sizeof(id_) && !data.empty()) {
+    id_ |= data.front() << (8 * id_pos_++);
+    data = data.subspan(1);
+    if (id_pos_ == sizeof(id_)) {
+      led_command_.set_hold(true);
+      led_command_.begin_frame(length_ - sizeof(id_));
+    }
+  }
+  if (id_pos_ == sizeof(id_) && !data.empty()) {
+    led_command_.frame_data(data);
+  }
+}
+
+void PresentCommand::end_frame(bool valid) {
+  if (id_pos_ < sizeof(id_)) return;
+  led_command_.end_frame(valid);
+  led_command_.set_hold(false);
+  if (!led_command_.held_frame_ok()) return;
+
+  memcpy(staged_, led_command_.leds(),
+         led_command_.num_leds() * sizeof(CRGB));
+  has_staged_ = true;
+  staged_id_ = id_;
+  scheduled_ = false;
+}
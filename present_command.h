@@ -0,0 +1,53 @@
+#pragma once
+
+#include <FastLED.h>
+#include <stdint.h>
+
+#include <span>
+#include <string_view>
+
+#include "command.h"
+#include "frame_slot.h"
+#include "led_command.h"
+
+// Synchronised presentation across controllers. A kFrameLedTagged binary frame
+// carries a little-endian uint16_t frame ID followed by a LedCommand payload.
+// It is decoded like any LED frame but staged instead of shown, until
+// "present:<id>[:<delay_ms>]" publishes it, immediately or delay_ms later. The
+// host stages a frame on every controller and then sends present to all of
+// them at once.
+//
+// One frame is staged at a time: a new tagged frame replaces it, cancelling a
+// present that has not happened yet.
+class PresentCommand : public Command {
+ public:
+  PresentCommand(LedCommand& led_command, CRGB* staged, FrameSlot& frames)
+      : Command("present", /*streaming=*/false, kFrameLedTagged),
+        led_command_(led_command),
+        staged_(staged),
+        frames_(frames) {}
+
+  void process(std::string_view args) override;
+
+  void begin_frame(size_t length) override;
+  void frame_data(std::span<const uint8_t> data) override;
+  void end_frame(bool valid) override;
+
+  // Publish the staged frame once its present time has come. Call from loop().
+  void poll(uint32_t now_ms);
+
+ private:
+  LedCommand& led_command_;
+  CRGB* staged_;  // led_command.num_leds() LEDs
+  FrameSlot& frames_;
+
+  bool has_staged_ = false;
+  uint16_t staged_id_ = 0;
+  bool scheduled_ = false;
+  uint32_t present_at_ms_ = 0;
+
+  // Tagged frame currently arriving
+  size_t length_ = 0;
+  uint8_t id_pos_ = 0;
+  uint16_t id_ = 0;
+};
@@ -0,0 +1,15 @@
+#include "rate_command.h"
+
+#include <charconv>
+#include <system_error>
+
+void RateCommand::process(std::string_view args) {
+  uint16_t max_hz;
+  auto result =
+      std::from_chars(args.data(), args.data() + args.size(), max_hz);
+  if (result.ec != std::errc() || result.ptr != args.data() + args.size()) {
+    Serial.println("Invalid rate command format");
+    return;
+  }
+  frames_.set_max_rate(max_hz);
+}
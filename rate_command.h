@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string_view>
+
+#include "command.h"
+#include "frame_slot.h"
+
+// "rate:<hz>" limits how often LED frames are shown, 0 removes the limit.
+// Frames arriving faster are coalesced so only the newest one is shown.
+class RateCommand : public Command {
+ public:
+  RateCommand(FrameSlot& frames) : Command("rate"), frames_(frames) {}
+
+  void process(std::string_view args) override;
+
+ private:
+  FrameSlot& frames_;
+};
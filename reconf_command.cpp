@@ -1,5 +1,7 @@
 #include "reconf_command.h"
 
+#include <charconv>
+
 bool ReconfCommand::parseIPAddress(const char* str, uint8_t* ip) {
   int values[4];
   if (sscanf(str, "%d.%d.%d.%d", &values[0], &values[1], &values[2],
@@ -16,38 +18,71 @@ bool ReconfCommand::parseIPAddress(const char* str, uint8_t* ip) {
   return true;
 }
 
+void ReconfCommand::reply(const char* state) {
+  tx_.print("{\"reconf\":\"");
+  tx_.print(state);
+  tx_.print("\",\"written\":");
+  tx_.print(ch9121_.FieldsWritten());
+  tx_.println("}");
+  tx_.commit();
+}
+
 void ReconfCommand::process(std::string_view args) {
-  // Format: "reconf:ip:port"
-  size_t colon1 = args.find(':');
-  if (colon1 == std::string_view::npos) {
-    Serial.println("Invalid reconf command format");
+  if (args == "status") {
+    reply(ch9121_.Busy() ? "busy" : result_);
     return;
   }
 
-  std::string_view ip_str = args.substr(0, colon1);
-  args = args.substr(colon1 + 1);
-
-  size_t colon2 = args.find(':');
-  if (colon2 == std::string_view::npos) {
+  // Format: "reconf:ip:port"
+  size_t colon = args.find(':');
+  if (colon == std::string_view::npos) {
     Serial.println("Invalid reconf command format");
     return;
   }
 
-  std::string_view port_str = args.substr(colon2 + 1);
+  std::string_view ip_str = args.substr(0, colon);
+  std::string_view port_str = args.substr(colon + 1);
 
-  uint16_t new_port = atoi(port_str.data());
+  uint32_t new_port = 0;
+  auto result = std::from_chars(port_str.data(),
+                                port_str.data() + port_str.size(), new_port);
+  bool port_valid = result.ec == std::errc() &&
+                    result.ptr == port_str.data() + port_str.size();
   uint8_t new_ip[4];
 
-  if (parseIPAddress(ip_str.data(), new_ip) && new_port > 0 &&
+  if (ch9121_.Busy()) {
+    Serial.println("Reconfiguration already in progress");
+    return;
+  }
+
+  if (parseIPAddress(ip_str.data(), new_ip) && port_valid && new_port > 0 &&
       new_port <= 65535) {
-    // Reconfigure the CH9120 with new target IP and port
+    // Reconfigure the CH9120 with new target IP and port. step() holds off
+    // configuration mode until this reply has gone out.
     ch9121_.Reconfigure(new_ip, new_port);
+    tx_.println("{\"reconf\":\"started\"}");
+    tx_.commit();
 
-    Serial.print("Reconfigured to ");
-    Serial.print(ip_str.data());
+    Serial.print("Reconfiguring to ");
+    Serial.write(ip_str.data(), ip_str.size());
     Serial.print(":");
     Serial.println(new_port);
   } else {
     Serial.println("Invalid IP or port format");
   }
 }
+
+bool ReconfCommand::step() {
+  if (!ch9121_.Busy()) return false;
+
+  // Queued replies must reach the host before the UART is switched over
+  if (!ch9121_.InConfigMode() && !tx_.empty()) return false;
+
+  if (ch9121_.Step()) return ch9121_.InConfigMode();
+
+  result_ = ch9121_.Responded() ? "done" : "failed";
+  reply(result_);
+  Serial.print("Reconfiguration finished, fields written: ");
+  Serial.println(ch9121_.FieldsWritten());
+  return false;
+}
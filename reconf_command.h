@@ -4,15 +4,35 @@
 
 #include "ch9120.h"
 #include "command.h"
+#include "tx_queue.h"
 
+// "reconf:<ip>:<port>" retargets the CH9121. {"reconf":"started"} is sent
+// before the module is reconfigured in the background by step(), and
+// {"reconf":"done","written":<fields>} (or "failed" if the module did not
+// answer) once it is back on the network. Saving new settings resets the
+// module and drops the host's connection, so that reply can be lost;
+// "reconf:status" repeats it, or answers "busy" or "idle".
+//
+// Data the host sends after "started" may arrive while the CH9121 is in
+// configuration mode and is then lost (see CH9121::Step()), so the host holds
+// everything but "reconf:status" back until the result.
 class ReconfCommand : public Command {
  public:
-  ReconfCommand(CH9121& ch9121) : Command("reconf"), ch9121_(ch9121) {}
+  ReconfCommand(CH9121& ch9121, TxQueue& tx)
+      : Command("reconf"), ch9121_(ch9121), tx_(tx) {}
 
   void process(std::string_view args) override;
 
+  // Advance a reconfiguration. Call from loop(). Returns true while the CH9121
+  // is in configuration mode, when Serial2 must not be read or written.
+  bool step();
+
  private:
   CH9121& ch9121_;
+  TxQueue& tx_;
+  const char* result_ = "idle";  // Outcome of the last reconfiguration
+
+  void reply(const char* state);
 
   // Helper function to parse IP address from string
   bool parseIPAddress(const char* str, uint8_t* ip);
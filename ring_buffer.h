@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <array>
+
+// Fixed-capacity FIFO for use from a single context. N must be a power of two.
+template <typename T, size_t N>
+class RingBuffer {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "N must be a power of two");
+
+ public:
+  bool empty() const { return head_ == tail_; }
+  bool full() const { return size() == N; }
+  size_t size() const { return head_ - tail_; }
+
+  // Append an item, returns false if the buffer is full
+  bool push(const T& item) {
+    if (full()) return false;
+    items_[head_++ & (N - 1)] = item;
+    return true;
+  }
+
+  // Remove the oldest item, returns false if the buffer is empty
+  bool pop(T& item) {
+    if (empty()) return false;
+    item = items_[tail_++ & (N - 1)];
+    return true;
+  }
+
+ private:
+  std::array<T, N> items_;
+  size_t head_ = 0;
+  size_t tail_ = 0;
+};
@@ -0,0 +1,47 @@
+#include "sequenced_led_command.h"
+
+#include <Arduino.h>
+
+void SequencedLedCommand::process(std::string_view args) {
+  Serial.println("ledseq is only accepted as a binary frame");
+}
+
+bool SequencedLedCommand::is_newer(uint16_t seq) const {
+  if (!have_seq_) return true;
+  int16_t ahead = static_cast<int16_t>(seq - last_seq_);
+  return ahead > 0 || ahead < -RESYNC_DISTANCE;
+}
+
+void SequencedLedCommand::begin_frame(size_t length) {
+  length_ = length;
+  seq_pos_ = 0;
+  seq_ = 0;
+  accepted_ = false;
+}
+
+void SequencedLedCommand::frame_data(std::span<const uint8_t> data) {
+  while (seq_pos_ < sizeof(seq_) && !data.empty()) {
+    seq_ |= data.front() << (8 * seq_pos_++);
+    data = data.subspan(1);
+    if (seq_pos_ == sizeof(seq_)) {
+      accepted_ = is_newer(seq_);
+      if (accepted_) {
+        led_command_.begin_frame(length_ - sizeof(seq_));
+      } else {
+        ++stats_.stale_frames;
+      }
+    }
+  }
+  if (accepted_ && !data.empty()) {
+    led_command_.frame_data(data);
+  }
+}
+
+void SequencedLedCommand::end_frame(bool valid) {
+  if (!accepted_) return;
+  led_command_.end_frame(valid);
+  if (valid) {
+    have_seq_ = true;
+    last_seq_ = seq_;
+  }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <span>
+#include <string_view>
+
+#include "command.h"
+#include "firmware_stats.h"
+#include "led_command.h"
+
+// kFrameLedSeq binary frames carry a little-endian uint16_t sequence number
+// followed by a LedCommand payload. They are meant for unreliable transports
+// such as the CH9121's UDP modes, so a frame whose sequence number is not newer
+// than the last one shown is a duplicate or arrived out of order and is
+// dropped before it touches the LED buffer. A sequence number more than
+// RESYNC_DISTANCE behind is taken as a restarted sender instead.
+//
+// Each frame should be self-contained (a full frame, or a patch frame that
+// covers every LED), since the frame before it may have been lost.
+class SequencedLedCommand : public Command {
+ public:
+  static constexpr int16_t RESYNC_DISTANCE = 64;
+
+  SequencedLedCommand(LedCommand& led_command, FirmwareStats& stats)
+      : Command("ledseq", /*streaming=*/false, kFrameLedSeq),
+        led_command_(led_command),
+        stats_(stats) {}
+
+  void process(std::string_view args) override;
+
+  void begin_frame(size_t length) override;
+  void frame_data(std::span<const uint8_t> data) override;
+  void end_frame(bool valid) override;
+
+ private:
+  LedCommand& led_command_;
+  FirmwareStats& stats_;
+
+  bool have_seq_ = false;  // Whether last_seq_ has been set
+  uint16_t last_seq_ = 0;  // Sequence number of the last frame shown
+
+  // Frame currently arriving
+  size_t length_ = 0;
+  uint8_t seq_pos_ = 0;
+  uint16_t seq_ = 0;
+  bool accepted_ = false;
+
+  // Whether a frame numbered seq should be shown
+  bool is_newer(uint16_t seq) const;
+};
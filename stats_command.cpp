@@ -0,0 +1,52 @@
+#include "stats_command.h"
+
+#include <Arduino.h>
+
+void StatsCommand::process(std::string_view args) {
+  tx_.print("{\"rx_bytes\":");
+  tx_.print(stats_.rx_bytes);
+  tx_.print(",\"rx_fifo_hw\":");
+  tx_.print(stats_.rx_fifo_high_water);
+  if (processor_) {
+    tx_.print(",\"truncated\":");
+    tx_.print(processor_->lines_truncated());
+    tx_.print(",\"unknown\":");
+    tx_.print(processor_->unknown_commands());
+    tx_.print(",\"crc_errors\":");
+    tx_.print(processor_->frame_crc_errors());
+    tx_.print(",\"frame_timeouts\":");
+    tx_.print(processor_->frame_timeouts());
+  }
+  tx_.print(",\"tx_dropped\":");
+  tx_.print(tx_.dropped());
+  tx_.print(",\"loop_us\":");
+  stats_.loop_us.print_json(tx_);
+  tx_.print(",\"show_us\":");
+  stats_.show_us.print_json(tx_);
+  tx_.print(",\"frames\":{\"published\":");
+  tx_.print(frames_.published());
+  tx_.print(",\"presented\":");
+  tx_.print(frames_.presented());
+  tx_.print(",\"dropped\":");
+  tx_.print(frames_.dropped());
+  tx_.print(",\"stale\":");
+  tx_.print(stats_.stale_frames);
+  tx_.print("},\"i2c\":{\"pca9555\":");
+  tx_.print(pca_.transactions());
+  tx_.print(",\"lcd_writes\":");
+  tx_.print(lcd_.lcd_writes());
+  tx_.print("},\"commands\":{");
+  if (processor_) {
+    bool first = true;
+    for (const Command* cmd : processor_->commands()) {
+      if (!first) tx_.print(',');
+      first = false;
+      tx_.print('"');
+      tx_.write(cmd->prefix().data(), cmd->prefix().size());
+      tx_.print("\":");
+      cmd->latency().print_json(tx_);
+    }
+  }
+  tx_.println("}}");
+  tx_.commit();
+}
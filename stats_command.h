@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string_view>
+
+#include "command.h"
+#include "firmware_stats.h"
+#include "frame_slot.h"
+#include "lcd_framebuffer.h"
+#include "pca9555.h"
+#include "tx_queue.h"
+
+// "stats" replies with a single JSON line of firmware metrics: receive, parse
+// and transmit counters, loop and FastLED.show() timing, LED frame counters, I2C
+// traffic and a dispatch count and latency histogram per command prefix.
+// Histograms are {"n":count,"max":us,"hist":[...]} with log2 microsecond
+// buckets, see LatencyHistogram.
+class StatsCommand : public Command {
+ public:
+  StatsCommand(FirmwareStats& stats, FrameSlot& frames, PCA9555& pca,
+               LcdFramebuffer& lcd, TxQueue& tx)
+      : Command("stats"),
+        stats_(stats),
+        frames_(frames),
+        pca_(pca),
+        lcd_(lcd),
+        tx_(tx) {}
+
+  void process(std::string_view args) override;
+
+  // The processor this command is registered with, for its counters and the
+  // per-command latencies
+  void set_processor(const CommandProcessor* processor) {
+    processor_ = processor;
+  }
+
+ private:
+  FirmwareStats& stats_;
+  FrameSlot& frames_;
+  PCA9555& pca_;
+  LcdFramebuffer& lcd_;
+  TxQueue& tx_;
+  const CommandProcessor* processor_ = nullptr;
+};
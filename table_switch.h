@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+
+// Hands tables built on core 0 to a reader on core 1 without locking. The
+// owner keeps three copies of its table: the writer builds into writable(),
+// which is neither the current one nor the one the reader may still be using,
+// and publish() makes it current. The reader claims the current copy with
+// acquire() before each pass over it.
+class TableSwitch {
+ public:
+  // Writer: index of a copy that is safe to rebuild
+  uint8_t writable() const {
+    uint8_t active = active_.load();
+    uint8_t in_use = in_use_.load();
+    uint8_t index = 0;
+    while (index == active || index == in_use) ++index;
+    return index;
+  }
+
+  // Writer: make copy index current
+  void publish(uint8_t index) {
+    active_.store(index);
+    version_.fetch_add(1, std::memory_order_release);
+  }
+
+  // Reader: claim the current copy, checking it was not replaced meanwhile so
+  // the writer will not pick it to rebuild. Sets version to the version of the
+  // copy returned, or an older one.
+  uint8_t acquire(uint32_t& version) {
+    uint8_t index;
+    do {
+      version = version_.load(std::memory_order_acquire);
+      index = active_.load();
+      in_use_.store(index);
+    } while (active_.load() != index);
+    return index;
+  }
+
+  // Incremented by every publish()
+  uint32_t version() const { return version_.load(std::memory_order_acquire); }
+
+ private:
+  std::atomic<uint8_t> active_{0};
+  std::atomic<uint8_t> in_use_{0};
+  std::atomic<uint32_t> version_{0};
+};
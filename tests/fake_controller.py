@@ -0,0 +1,269 @@
+"""Stand-ins for the controller firmware on loopback sockets.
+
+They speak the firmware's protocol as far as control_port.py uses it: text
+commands and binary frames in, JSON replies and credits out.
+"""
+
+import asyncio
+import binascii
+import json
+import random
+
+from control_port import (
+    FRAME_LED_SEQ,
+    FRAME_SYNC,
+    LED_OP_FILL,
+    LED_OP_RUNS,
+    LED_OP_SET,
+    LED_PATCH_FRAME,
+)
+
+# See SequencedLedCommand in the firmware
+RESYNC_DISTANCE = 64
+
+
+def decode_frame(data):
+    """Return (type, payload) of a complete binary frame, or None if invalid."""
+    if len(data) < 6 or data[0] != FRAME_SYNC:
+        return None
+    length = data[2] | data[3] << 8
+    if len(data) != length + 6:
+        return None
+    crc = data[-2] | data[-1] << 8
+    if binascii.crc_hqx(data[1:-2], 0xFFFF) != crc:
+        return None
+    return data[1], data[4:-2]
+
+
+def apply_leds(leds, payload):
+    """Return leds with an LED payload applied, as LedCommand does.
+
+    A full frame replaces the LEDs, a patch frame changes them in place.
+    Raises ValueError on a malformed payload.
+    """
+    count = payload[0] | payload[1] << 8
+    if count != LED_PATCH_FRAME:
+        if len(payload) != 2 + 3 * count:
+            raise ValueError("Truncated full frame")
+        return [tuple(payload[i : i + 3]) for i in range(2, len(payload), 3)]
+    leds = list(leds)
+    pos = 2
+
+    def take(size):
+        nonlocal pos
+        if pos + size > len(payload):
+            raise ValueError("Truncated patch record")
+        pos += size
+        return payload[pos - size : pos]
+
+    def put(index, color):
+        if index >= len(leds):
+            raise ValueError("Patch past the last LED")
+        leds[index] = tuple(color)
+
+    while pos < len(payload):
+        op = take(1)[0]
+        if op == 0:
+            continue
+        start = int.from_bytes(take(2), "little")
+        if op == LED_OP_SET:
+            for i in range(take(1)[0]):
+                put(start + i, take(3))
+        elif op == LED_OP_FILL:
+            length = int.from_bytes(take(2), "little")
+            color = take(3)
+            for i in range(length):
+                put(start + i, color)
+        elif op == LED_OP_RUNS:
+            for _ in range(take(1)[0]):
+                length, color = take(1)[0], take(3)
+                for i in range(length):
+                    put(start, color)
+                    start += 1
+        else:
+            raise ValueError(f"Unknown patch op {op}")
+    return leds
+
+
+class FakeController:
+    def __init__(self, host="127.0.0.1", dip=0, window=None):
+        self.host = host
+        self.port = None
+        self.dip = dip
+        self.window = window  # Credit window announced by enum, None for none
+        self.credits = True  # Whether to return credits as data is consumed
+        self.lines = []  # Text commands received, without the newline
+        self.frames = []  # Binary frames received as (type, payload)
+        self.bad_frames = 0  # Binary frames with a bad CRC
+        self.connections = 0
+        self.reconf_result = "idle"
+        self.reconf_written = 0
+        self._server = None
+        self._writers = set()
+        self._handlers = set()
+
+    async def start(self, port=0):
+        self._server = await asyncio.start_server(self._serve, self.host, port)
+        self.port = self._server.sockets[0].getsockname()[1]
+        return self
+
+    async def stop(self):
+        self.drop_connections()
+        self._server.close()
+        # Closing the connections ends the handlers with end of stream
+        await asyncio.gather(*self._handlers)
+        await self._server.wait_closed()
+
+    def send(self, message):
+        """Send a JSON message to every connected host."""
+        data = (json.dumps(message, separators=(",", ":")) + "\r\n").encode()
+        for writer in self._writers:
+            writer.write(data)
+
+    def drop_connections(self):
+        """Close every connection, as the CH9121 does when it resets."""
+        for writer in list(self._writers):
+            writer.close()
+        self._writers.clear()
+
+    def on_line(self, line):
+        """Handle a text command. Override to script other replies."""
+        command, _, args = line.partition(":")
+        if command == "enum":
+            reply = {"type": "controller", "dip": self.dip}
+            if self.window:
+                reply["window"] = self.window
+            self.send(reply)
+        elif command == "reconf" and args == "status":
+            self.send({"reconf": self.reconf_result, "written": self.reconf_written})
+        elif command == "reconf":
+            self.on_reconf(args)
+
+    def on_reconf(self, args):
+        """Start a reconfiguration that saves new settings, so the module resets
+        and the "done" reply is lost with the connection."""
+        self.send({"reconf": "started"})
+        self.reconf_result = "busy"
+
+        def reset():
+            self.drop_connections()
+            self.reconf_result = "done"
+            self.reconf_written = 2
+
+        asyncio.get_running_loop().call_later(0.05, reset)
+
+    def on_frame(self, frame_type, payload):
+        """Handle a binary frame with a good CRC."""
+        self.frames.append((frame_type, payload))
+
+    async def _serve(self, reader, writer):
+        self.connections += 1
+        self._writers.add(writer)
+        self._handlers.add(asyncio.current_task())
+        try:
+            while True:
+                first = await reader.readexactly(1)
+                consumed = 1
+                if first[0] == FRAME_SYNC:
+                    header = await reader.readexactly(3)
+                    length = header[1] | header[2] << 8
+                    rest = await reader.readexactly(length + 2)
+                    consumed += 3 + len(rest)
+                    payload, crc = rest[:length], rest[length] | rest[length + 1] << 8
+                    if binascii.crc_hqx(header + payload, 0xFFFF) == crc:
+                        self.on_frame(header[0], payload)
+                    else:
+                        self.bad_frames += 1
+                else:
+                    line = first
+                    if first != b"\n":
+                        line += await reader.readuntil(b"\n")
+                    consumed += len(line) - 1
+                    line = line.strip().decode()
+                    if line:
+                        self.lines.append(line)
+                        self.on_line(line)
+                if self.window and self.credits:
+                    self.send({"credit": consumed})
+        except (asyncio.IncompleteReadError, ConnectionError):
+            pass
+        finally:
+            self._writers.discard(writer)
+            self._handlers.discard(asyncio.current_task())
+            writer.close()
+
+
+class FakeUdpController(asyncio.DatagramProtocol):
+    """A controller whose CH9121 is in UDP server mode, behind a link that
+    loses a fraction loss of the datagrams and holds back a fraction reorder
+    of them until after the next one. Sequenced LED frames are shown under the
+    firmware's rules."""
+
+    def __init__(self, num_leds, host="127.0.0.1", loss=0.0, reorder=0.0, seed=1):
+        self.host = host
+        self.port = None
+        self.leds = [(0, 0, 0)] * num_leds
+        self.loss = loss
+        self.reorder = reorder
+        self.shown = []  # (sequence number, LEDs) of the frames shown, in order
+        self.received = 0  # Datagrams sent to the controller, lost or not
+        self.lost = 0
+        self.stale_frames = 0
+        self.bad_frames = 0
+        self._random = random.Random(seed)
+        self._held = None
+        self._last_seq = None
+        self._transport = None
+
+    async def start(self, port=0):
+        loop = asyncio.get_running_loop()
+        self._transport, _ = await loop.create_datagram_endpoint(
+            lambda: self, local_addr=(self.host, port)
+        )
+        self.port = self._transport.get_extra_info("sockname")[1]
+        return self
+
+    async def stop(self):
+        self._transport.close()
+
+    def flush(self):
+        """Deliver a datagram held back for reordering."""
+        held, self._held = self._held, None
+        if held:
+            self._deliver(held)
+
+    def datagram_received(self, data, addr):
+        self.received += 1
+        if self._random.random() < self.loss:
+            self.lost += 1
+            return
+        if self._held is None and self._random.random() < self.reorder:
+            self._held = data
+            return
+        self._deliver(data)
+        self.flush()
+
+    def _is_newer(self, seq):
+        if self._last_seq is None:
+            return True
+        ahead = (seq - self._last_seq) & 0xFFFF
+        ahead = ahead - 0x10000 if ahead >= 0x8000 else ahead
+        return ahead > 0 or ahead < -RESYNC_DISTANCE
+
+    def _deliver(self, data):
+        frame = decode_frame(data)
+        if frame is None or frame[0] != FRAME_LED_SEQ:
+            self.bad_frames += 1
+            return
+        payload = frame[1]
+        seq = payload[0] | payload[1] << 8
+        if not self._is_newer(seq):
+            self.stale_frames += 1
+            return
+        try:
+            self.leds = apply_leds(self.leds, payload[2:])
+        except ValueError:
+            self.bad_frames += 1
+            return
+        self._last_seq = seq
+        self.shown.append((seq, self.leds))
@@ -0,0 +1,264 @@
+"""Tests of control_port.py against fake controllers on loopback sockets.
+
+    python3 -m unittest discover -s tests -t .
+"""
+
+import asyncio
+import time
+import unittest
+from unittest import mock
+
+import control_port
+from control_port import ControllerState, ControlPort
+from tests.fake_controller import FakeController, FakeUdpController, apply_leds
+
+
+async def stop(state):
+    """Stop state's receive path and close its connection."""
+    if state._listen_task:
+        state._listen_task.cancel()
+        await asyncio.gather(state._listen_task, return_exceptions=True)
+    state.disconnect()
+
+
+class ReconfigureTest(unittest.IsolatedAsyncioTestCase):
+    async def asyncSetUp(self):
+        self.controller = await FakeController().start()
+        loop = asyncio.get_running_loop()
+        self.state = ControllerState("127.0.0.1", 0, loop, port=self.controller.port)
+
+    async def asyncTearDown(self):
+        await stop(self.state)
+        await self.controller.stop()
+
+    async def test_polls_for_the_result_lost_in_the_reset(self):
+        with mock.patch.object(control_port, "RECONF_POLL", 0.05):
+            reply = await self.state.reconfigure("192.168.0.7", 50000, timeout=2.0)
+
+        self.assertEqual(reply, {"reconf": "done", "written": 2})
+        self.assertEqual(self.controller.lines[0], "reconf:192.168.0.7:50000")
+        self.assertIn("reconf:status", self.controller.lines)
+        self.assertEqual(self.controller.connections, 2)
+
+    async def test_holds_other_messages_until_done(self):
+        with mock.patch.object(control_port, "RECONF_POLL", 0.05):
+            reconfigure = asyncio.ensure_future(
+                self.state.reconfigure("192.168.0.7", 50000, timeout=2.0)
+            )
+            while not self.controller.lines:
+                await asyncio.sleep(0.005)
+            # Sent now, it would arrive while the CH9121 is in config mode
+            lcd = asyncio.ensure_future(self.state.set_lcd(0, 0, "hello"))
+            await asyncio.sleep(0.03)
+            self.assertFalse(lcd.done())
+
+            await reconfigure
+            await asyncio.wait_for(lcd, 1.0)
+        await asyncio.sleep(0.05)
+        self.assertNotIn("lcd:0:0:hello", self.controller.lines[:-1])
+        self.assertEqual(self.controller.lines[-1], "lcd:0:0:hello")
+
+    async def test_returns_the_result_sent_before_any_reset(self):
+        def on_reconf(args):
+            # Nothing differed, so nothing was saved and the module stayed up
+            self.controller.send({"reconf": "started"})
+            self.controller.send({"reconf": "done", "written": 0})
+
+        self.controller.on_reconf = on_reconf
+        reply = await self.state.reconfigure("192.168.0.7", 50000, timeout=2.0)
+
+        self.assertEqual(reply, {"reconf": "done", "written": 0})
+        self.assertEqual(self.controller.connections, 1)
+
+    async def test_gives_up_on_a_controller_that_never_starts(self):
+        self.controller.on_reconf = lambda args: None
+
+        reply = await self.state.reconfigure("192.168.0.7", 50000, timeout=0.2)
+
+        self.assertIsNone(reply)
+
+
+class DiscoveryTest(unittest.IsolatedAsyncioTestCase):
+    async def asyncSetUp(self):
+        # Controllers at two of the addresses 127.0.0.1-6, on the same port
+        self.first = await FakeController("127.0.0.2", dip=3, window=128).start()
+        self.second = await FakeController("127.0.0.5", dip=9).start(self.first.port)
+        self.fakes = [self.first, self.second]
+        self.port = ControlPort("127.0.0.", 1, 6, port=self.first.port)
+
+    async def asyncTearDown(self):
+        for state in self.port.controllers.values():
+            await stop(state)
+        for fake in self.fakes:
+            await fake.stop()
+
+    async def test_finds_each_controller_and_keeps_its_connection(self):
+        controllers = await self.port.enumerate(timeout=1.0)
+
+        self.assertEqual(sorted(controllers), ["127.0.0.2", "127.0.0.5"])
+        self.assertEqual(controllers["127.0.0.2"].dip, 3)
+        self.assertEqual(controllers["127.0.0.2"].window, 128)
+        self.assertEqual(controllers["127.0.0.5"].dip, 9)
+        self.assertIsNone(controllers["127.0.0.5"].window)
+
+        await controllers["127.0.0.5"].set_lcd(0, 0, "hello")
+        await asyncio.sleep(0.05)
+        self.assertEqual(self.second.lines, ["enum", "lcd:0:0:hello"])
+        self.assertEqual(self.second.connections, 1)
+
+    async def test_queries_every_address_at_once(self):
+        # A device that accepts connections but never answers enum
+        silent = FakeController("127.0.0.3")
+        silent.on_line = lambda line: None
+        self.fakes.append(await silent.start(self.first.port))
+
+        start = time.monotonic()
+        controllers = await self.port.enumerate(timeout=0.3)
+        elapsed = time.monotonic() - start
+
+        self.assertEqual(len(controllers), 2)
+        self.assertLess(elapsed, 0.6)
+
+    async def test_delivers_messages_read_ahead_with_the_enum_reply(self):
+        def on_line(line):
+            # The reply and a button event arrive in the same read
+            self.first.send({"type": "controller", "dip": 3, "window": 128})
+            self.first.send({"buttons": [1, 0, 0], "t": 5})
+
+        self.first.on_line = on_line
+        controllers = await self.port.enumerate(timeout=1.0)
+        pressed = asyncio.get_running_loop().create_future()
+        controllers["127.0.0.2"].register_button_callback(pressed.set_result)
+
+        self.assertEqual(await asyncio.wait_for(pressed, 1.0), [1, 0, 0])
+
+    async def test_holds_writes_until_the_window_has_room(self):
+        controllers = await self.port.enumerate(timeout=1.0)
+        state = controllers["127.0.0.2"]
+        self.first.credits = False
+        text = "x" * 60  # 69-byte messages, two of which overflow the window
+
+        await state.set_lcd(0, 0, text)
+        second = asyncio.ensure_future(state.set_lcd(0, 1, text))
+        await asyncio.sleep(0.1)
+        self.assertFalse(second.done())
+        self.assertEqual(len(self.first.lines), 2)
+
+        self.first.send({"credit": 69})
+        await asyncio.wait_for(second, 1.0)
+        await asyncio.sleep(0.05)
+        self.assertEqual(self.first.lines[-1], f"lcd:0:1:{text}")
+        self.assertEqual(state._in_flight, 69)
+
+
+class CoalescingTest(unittest.IsolatedAsyncioTestCase):
+    async def asyncSetUp(self):
+        self.controller = await FakeController().start()
+        loop = asyncio.get_running_loop()
+        self.state = ControllerState("127.0.0.1", 0, loop, port=self.controller.port)
+
+    async def asyncTearDown(self):
+        await stop(self.state)
+        await self.controller.stop()
+
+    async def test_keeps_the_latest_frame_and_keyframe(self):
+        red, green, blue = [(255, 0, 0)] * 4, [(0, 255, 0)] * 4, [(0, 0, 255)] * 4
+        await asyncio.gather(
+            self.state.set_leds(red),
+            self.state.transition_leds(green, 100),
+            self.state.set_leds(blue),
+        )
+        await asyncio.sleep(0.05)
+
+        types = [frame_type for frame_type, _ in self.controller.frames]
+        self.assertEqual(types, [control_port.FRAME_LED_TRANSITION, control_port.FRAME_LED])
+        keyframe, frame = (payload for _, payload in self.controller.frames)
+        self.assertEqual(apply_leds([(0, 0, 0)] * 4, keyframe[3:]), green)
+        # Patched against the keyframe, which the controller jumps to
+        self.assertEqual(apply_leds(green, frame), blue)
+
+
+class UdpTransportTest(unittest.IsolatedAsyncioTestCase):
+    NUM_LEDS = 64
+
+    async def start(self, **link):
+        self.controller = await FakeUdpController(self.NUM_LEDS, **link).start()
+        self.state = self.new_state()
+
+    def new_state(self):
+        loop = asyncio.get_running_loop()
+        return ControllerState("127.0.0.1", 0, loop, transport="udp", port=self.controller.port)
+
+    async def asyncTearDown(self):
+        await stop(self.state)
+        await self.controller.stop()
+
+    @staticmethod
+    def frame(index):
+        """A gradient with one white LED, so consecutive frames differ little
+        and a delta would be much smaller than a full frame."""
+        colors = [(i * 4, 255 - i * 4, 32) for i in range(UdpTransportTest.NUM_LEDS)]
+        colors[index % len(colors)] = (255, 255, 255)
+        return colors
+
+    async def send_frames(self, first, count):
+        """Send frames first.. and return them by sequence number."""
+        sent = {}
+        expected = self.controller.received + count
+        for i in range(first, first + count):
+            await self.state.set_leds(self.frame(i))
+            sent[self.state._seq] = self.frame(i)
+        for _ in range(200):
+            if self.controller.received >= expected:
+                break
+            await asyncio.sleep(0.005)
+        self.controller.flush()
+        self.assertEqual(self.controller.received, expected)
+        return sent
+
+    async def test_shows_whole_newer_frames_despite_loss_and_reordering(self):
+        await self.start(loss=0.2, reorder=0.2, seed=7)
+        sent = await self.send_frames(0, 300)
+
+        self.assertGreater(self.controller.lost, 0)
+        self.assertGreater(self.controller.stale_frames, 0)
+        self.assertEqual(self.controller.bad_frames, 0)
+        seqs = [seq for seq, _ in self.controller.shown]
+        self.assertEqual(seqs, sorted(seqs))
+        self.assertEqual(len(seqs), len(set(seqs)))
+        # Every frame shown is exactly the one sent, whatever was lost before it
+        for seq, leds in self.controller.shown:
+            self.assertEqual(leds, sent[seq])
+
+    async def test_sequence_numbers_wrap_around(self):
+        await self.start()
+        self.state._seq = 0xFFF0
+        sent = await self.send_frames(0, 40)
+
+        self.assertEqual([seq for seq, _ in self.controller.shown], list(sent))
+        self.assertEqual(self.controller.shown[-1][0], 24)
+
+    async def test_rejects_frames_too_large_for_a_datagram(self):
+        await self.start()
+        distinct = [(i & 0xFF, i >> 8, 0) for i in range(500)]
+
+        with self.assertRaises(ValueError):
+            await self.state.set_leds(distinct)
+        # Run-length encoding brings a plain strip of as many LEDs well under
+        await self.state.set_leds([(9, 9, 9)] * 500)
+
+    async def test_follows_a_restarted_host(self):
+        await self.start()
+        self.state._seq = 1000
+        await self.send_frames(0, 5)
+        await stop(self.state)
+
+        self.state = self.new_state()
+        sent = await self.send_frames(5, 5)
+
+        self.assertEqual(self.controller.stale_frames, 0)
+        self.assertEqual(self.controller.shown[-1], (5, sent[5]))
+
+
+if __name__ == "__main__":
+    unittest.main()
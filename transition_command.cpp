@@ -0,0 +1,43 @@
+#include "transition_command.h"
+
+#include <Arduino.h>
+
+void TransitionCommand::process(std::string_view args) {
+  Serial.println("transition is only accepted as a binary frame");
+}
+
+void TransitionCommand::begin_frame(size_t length) {
+  length_ = length;
+  header_pos_ = 0;
+}
+
+void TransitionCommand::frame_data(std::span<const uint8_t> data) {
+  while (header_pos_ < HEADER_SIZE && !data.empty()) {
+    header_[header_pos_++] = data.front();
+    data = data.subspan(1);
+    if (header_pos_ == HEADER_SIZE) {
+      engine_.capture();
+      led_command_.set_hold(true);
+      led_command_.begin_frame(length_ - HEADER_SIZE);
+    }
+  }
+  if (header_pos_ == HEADER_SIZE && !data.empty()) {
+    led_command_.frame_data(data);
+  }
+}
+
+void TransitionCommand::end_frame(bool valid) {
+  if (header_pos_ < HEADER_SIZE) return;
+  led_command_.end_frame(valid);
+  led_command_.set_hold(false);
+  if (!led_command_.held_frame_ok()) {
+    // Undo the partly drawn keyframe
+    engine_.restore();
+    return;
+  }
+
+  uint16_t duration_ms = header_[0] | (header_[1] << 8);
+  uint8_t easing = header_[2];
+  if (easing > EffectEngine::kEaseInOutCubic) easing = EffectEngine::kLinear;
+  engine_.transition(duration_ms, static_cast<EffectEngine::Easing>(easing));
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <span>
+#include <string_view>
+
+#include "command.h"
+#include "effect_engine.h"
+#include "led_command.h"
+
+// kFrameLedTransition binary frames carry a keyframe: a little-endian uint16_t
+// duration in milliseconds and an EffectEngine::Easing byte, followed by a
+// LedCommand payload. Instead of being shown at once, the keyframe is blended
+// to from the current LEDs over the duration by the EffectEngine, so the host
+// can send a few keyframes per second for smooth high frame rate output.
+// Patch payloads apply on top of the previous keyframe.
+class TransitionCommand : public Command {
+ public:
+  TransitionCommand(LedCommand& led_command, EffectEngine& engine)
+      : Command("transition", /*streaming=*/false, kFrameLedTransition),
+        led_command_(led_command),
+        engine_(engine) {}
+
+  void process(std::string_view args) override;
+
+  void begin_frame(size_t length) override;
+  void frame_data(std::span<const uint8_t> data) override;
+  void end_frame(bool valid) override;
+
+ private:
+  static constexpr size_t HEADER_SIZE = 3;
+
+  LedCommand& led_command_;
+  EffectEngine& engine_;
+
+  // Keyframe currently arriving
+  size_t length_ = 0;
+  uint8_t header_[HEADER_SIZE];
+  uint8_t header_pos_ = 0;
+};
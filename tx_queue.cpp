@@ -0,0 +1,41 @@
+#include "tx_queue.h"
+
+#include <algorithm>
+
+size_t TxQueue::write(uint8_t c) { return write(&c, 1); }
+
+size_t TxQueue::write(const uint8_t* buffer, size_t size) {
+  if (overflow_ || size > space()) {
+    overflow_ = true;
+    return 0;
+  }
+  for (size_t i = 0; i < size; ++i) {
+    buffer_[end_++ & (CAPACITY - 1)] = buffer[i];
+  }
+  return size;
+}
+
+bool TxQueue::commit() {
+  if (overflow_) {
+    end_ = committed_;
+    overflow_ = false;
+    ++dropped_;
+    return false;
+  }
+  committed_ = end_;
+  return true;
+}
+
+void TxQueue::service() {
+  while (sent_ != committed_) {
+    int room = uart_->availableForWrite();
+    if (room <= 0) return;
+    // Send up to the end of the committed data or of the ring, whichever is
+    // first
+    size_t offset = sent_ & (CAPACITY - 1);
+    size_t count = std::min<size_t>(
+        {committed_ - sent_, CAPACITY - offset, static_cast<size_t>(room)});
+    uart_->write(buffer_ + offset, count);
+    sent_ += count;
+  }
+}
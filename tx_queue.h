@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Arduino.h>
+#include <HardwareSerial.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Outbound message queue for the network UART. Messages are formatted into the
+// queue with the Print interface and made visible with commit(); service()
+// then sends as much as the UART can take without blocking. A message that
+// does not fit is dropped whole when it is committed.
+class TxQueue : public Print {
+ public:
+  static constexpr size_t CAPACITY = 4096;
+
+  explicit TxQueue(HardwareSerial* uart) : uart_(uart) {}
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+
+  // Finish the message written since the last commit(). Returns false, and
+  // discards it, if it did not fit.
+  bool commit();
+
+  // Bytes that can still be queued
+  size_t space() const { return CAPACITY - (end_ - sent_); }
+
+  // True once every committed message has been handed to the UART
+  bool empty() const { return sent_ == committed_; }
+
+  // Send queued messages while the UART has TX space. Call from loop().
+  void service();
+
+  // Number of messages dropped because the queue was full
+  uint32_t dropped() const { return dropped_; }
+
+ private:
+  static_assert((CAPACITY & (CAPACITY - 1)) == 0,
+                "CAPACITY must be a power of two");
+
+  HardwareSerial* uart_;
+  uint8_t buffer_[CAPACITY];
+  uint32_t sent_ = 0;       // Next byte to send
+  uint32_t committed_ = 0;  // End of committed messages
+  uint32_t end_ = 0;        // End of the message being written
+  bool overflow_ = false;
+  uint32_t dropped_ = 0;
+};